@@ -0,0 +1,520 @@
+	/*
+File:		allpairs.cpp
+Title:		Class definitions for class "allpairs" (declared in allpairs.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+#include <pthread.h>
+#include "dna.h"
+#include "dynamic.h"
+#include "kmer.h"
+#include "device.h"
+#include "allpairs.h"
+
+/******************************************************************************/
+
+// constructor for class allpairs
+
+allpairs::allpairs( vector<dna>& s, const dynamic& d, int t, int ts )
+	:
+	sequences_( s ),
+	proto_( d ),
+	threads_( t > 0 ? t : processors() ),
+	tilesize_( ts > 0 ? ts : ALLTILE ),
+	width_( tilesize_ ),
+	filter_( 0 ),
+	bandwidth_( DYNNOBAND ),
+	device_( 0 ),
+	listed_( false ),
+	from_( 0 ),
+	rows_( 0 ),
+	ranges_( threads_ ),
+	alignments_( 0 ),
+	offloaded_( 0 ),
+	cells_( 0 ),
+	stopped_( 0 ),
+	abandoned_( 0 )
+{
+	for( int k = 0; k < threads_; k++ )
+	{
+		pthread_mutex_init( &ranges_[k].lock_, NULL );
+		ranges_[k].lo_ = ranges_[k].hi_ = 0;
+	}
+}
+
+/******************************************************************************/
+
+// destructor for class allpairs
+
+allpairs::~allpairs()
+{
+	for( int k = 0; k < threads_; k++ )
+	{
+		pthread_mutex_destroy( &ranges_[k].lock_ );
+	}
+}
+
+/******************************************************************************/
+
+// the number of online processors (at least 1)
+
+int allpairs::processors( void )
+{
+	long n = sysconf( _SC_NPROCESSORS_ONLN );
+	return n > 0 ? static_cast<int>( n ) : 1;
+}
+
+/******************************************************************************/
+
+// align all the pairs of sequences (i, j) with j >= from, and i < rows unless
+//	rows is negative
+
+void allpairs::run( int from, int rows )
+{
+	int n = static_cast<int>( sequences_.size() );
+
+	// unbanded tiles are made wide enough for their rows to be given to
+	// the batch kernel (see allpairs.h, 2.1)
+	width_ = tilesize_;
+	if( bandwidth_ < 0 )
+	{
+		width_ *= ( DYNBATCH + tilesize_ - 1 ) / tilesize_;
+	}
+	int blocks = ( n + width_ - 1 ) / width_;
+
+	// number the tiles of the triangle row by row, leaving out the columns
+	// of tiles before from and the rows of tiles from rows on
+	from_ = max( from, 0 );
+	rows_ = ( rows < 0 || rows > n ) ? n : rows;
+	tiles_.clear();
+	for( int bi = 0; bi * tilesize_ < rows_; bi++ )
+	{
+		for( int bj = max( bi * tilesize_, from_ ) / width_; bj < blocks;
+			bj++ )
+		{
+			tiles_.push_back( pair<int, int>( bi, bj ) );
+		}
+	}
+
+	listed_ = false;
+	dispatch( static_cast<int>( tiles_.size() ) );
+}
+
+/******************************************************************************/
+
+// align a list of pairs of sequences
+
+void allpairs::run( const vector< pair<int, int> >& pairs )
+{
+	// sort the pairs (so that pairs with the same x-sequence follow each
+	// other) and remove the duplicates
+	list_ = pairs;
+	sort( list_.begin(), list_.end() );
+	list_.erase( unique( list_.begin(), list_.end() ), list_.end() );
+
+	listed_ = true;
+	dispatch( cut() );
+}
+
+/******************************************************************************/
+
+// cut the list into tiles (see allpairs.h, 2.1) of at least tilesize_ pairs,
+//	extended to the end of the row of their last pair, and return their
+//	number
+
+int allpairs::cut( void )
+{
+	int size = static_cast<int>( list_.size() );
+
+	tiles_.clear();
+	for( int begin = 0; begin < size; )
+	{
+		int end = min( begin + tilesize_, size );
+		while( end < size && list_[end].first == list_[end-1].first )
+		{
+			end++;
+		}
+		tiles_.push_back( pair<int, int>( begin, end ) );
+		begin = end;
+	}
+	return static_cast<int>( tiles_.size() );
+}
+
+/******************************************************************************/
+
+// run a number of tiles on the threads, and merge their results
+
+void allpairs::dispatch( int ntiles )
+{
+	int k;
+
+	edges_.clear();
+	alignments_ = 0;
+	offloaded_ = 0;
+	cells_ = stopped_ = abandoned_ = 0;
+
+	// the threads only align the pairs the device leaves
+	if( device_ && ondevice( ntiles ) )
+	{
+		listed_ = true;
+		ntiles = cut();
+	}
+
+	// give each thread an equal contiguous range of tiles
+	for( k = 0; k < threads_; k++ )
+	{
+		ranges_[k].lo_ = static_cast<int>
+			( static_cast<double>( ntiles ) * k / threads_ );
+		ranges_[k].hi_ = static_cast<int>
+			( static_cast<double>( ntiles ) * ( k+1 ) / threads_ );
+	}
+
+	vector<worker> workers( threads_ );
+	vector<pthread_t> ids( threads_ );
+	for( k = 0; k < threads_; k++ )
+	{
+		workers[k].engine_ = this;
+		workers[k].id_ = k;
+		workers[k].alignments_ = 0;
+		workers[k].cells_ = 0;
+		workers[k].stopped_ = 0;
+		workers[k].abandoned_ = 0;
+	}
+
+	// the calling thread is the first worker, so that a single thread
+	// runs without creating any
+	for( k = 1; k < threads_; k++ )
+	{
+		if( pthread_create( &ids[k], NULL, start, &workers[k] ) != 0 )
+		{
+			cerr	<< "ERROR: could not create alignment thread."
+				<< endl;
+			exit( EXIT_FAILURE );
+		}
+	}
+	work( workers[0] );
+	for( k = 1; k < threads_; k++ )
+	{
+		pthread_join( ids[k], NULL );
+	}
+
+	// merge the edges and counts of the threads
+	size_t total = 0;
+	for( k = 0; k < threads_; k++ )
+	{
+		total += workers[k].edges_.size();
+	}
+	edges_.reserve( edges_.size() + total );
+	for( k = 0; k < threads_; k++ )
+	{
+		edges_.insert( edges_.end(), workers[k].edges_.begin(),
+			workers[k].edges_.end() );
+		alignments_ += workers[k].alignments_;
+		cells_ += workers[k].cells_;
+		stopped_ += workers[k].stopped_;
+		abandoned_ += workers[k].abandoned_;
+	}
+	sort( edges_.begin(), edges_.end() );
+}
+
+/******************************************************************************/
+
+// align the pairs of the tiles that pass the prefilter on the device (see
+//	allpairs.h, 2.2), DEVICEPAIRS at a time, and leave those it gives back
+//	in the list. Returns false, having aligned nothing, if the device can
+//	not be used or fails.
+
+bool allpairs::ondevice( int ntiles )
+{
+	if( bandwidth_ >= 0 || !device_->available()
+		|| !device_->scoring( proto_ ) || !device_->upload( sequences_ ) )
+	{
+		return false;
+	}
+
+	int n = static_cast<int>( sequences_.size() );
+	vector< pair<int, int> > pairs, rest, edges;
+	pairs.reserve( DEVICEPAIRS );
+	size_t given = 0;
+
+	for( int t = 0; t < ntiles; t++ )
+	{
+		if( listed_ )
+		{
+			for( int k = tiles_[t].first; k < tiles_[t].second; k++ )
+			{
+				int i = list_[k].first, j = list_[k].second;
+				if( !filter_ || filter_->pass( i, j ) )
+				{
+					pairs.push_back( list_[k] );
+				}
+			}
+		}
+		else
+		{
+			int ibegin = tiles_[t].first * tilesize_;
+			int jbegin = tiles_[t].second * width_;
+			int iend = min( ibegin + tilesize_, rows_ );
+			int jend = min( jbegin + width_, n );
+			for( int i = ibegin; i < iend; i++ )
+			{
+				for( int j = max( max( jbegin, i+1 ), from_ );
+					j < jend; j++ )
+				{
+					if( !filter_ || filter_->pass( i, j ) )
+					{
+						pairs.push_back
+							( pair<int, int>( i, j ) );
+					}
+				}
+			}
+		}
+
+		if( static_cast<int>( pairs.size() ) >= DEVICEPAIRS
+			|| t == ntiles - 1 )
+		{
+			if( !device_->align( pairs, edges, rest ) )
+			{
+				return false;
+			}
+			given += pairs.size();
+			pairs.clear();
+		}
+	}
+
+	offloaded_ = static_cast<double>( given - rest.size() );
+	alignments_ = offloaded_;
+	edges_.swap( edges );
+	sort( rest.begin(), rest.end() );
+	list_.swap( rest );
+	return true;
+}
+
+/******************************************************************************/
+
+// thread entry point
+
+void* allpairs::start( void* arg )
+{
+	worker* w = static_cast<worker*>( arg );
+	w->engine_->work( *w );
+	return NULL;
+}
+
+/******************************************************************************/
+
+// the loop of a thread: process tiles until there are none left anywhere
+
+void allpairs::work( worker& w )
+{
+	// the thread's own workspace, aligning scores only
+	dynamic d( proto_ );
+	d.mode( DYNSCORE );
+
+	int t;
+	while( take( w.id_, t ) || steal( w.id_, t ) )
+	{
+		tile( t, d, w );
+	}
+}
+
+/******************************************************************************/
+
+// take the next tile from the front of a thread's own range
+
+bool allpairs::take( int k, int& t )
+{
+	bool found = false;
+
+	pthread_mutex_lock( &ranges_[k].lock_ );
+	if( ranges_[k].lo_ < ranges_[k].hi_ )
+	{
+		t = ranges_[k].lo_++;
+		found = true;
+	}
+	pthread_mutex_unlock( &ranges_[k].lock_ );
+
+	return found;
+}
+
+/******************************************************************************/
+
+// steal the back half of the longest range of the other threads. The first
+//	stolen tile is returned, and the rest become the thread's own range.
+//	Returns false when no thread has any tiles left.
+
+bool allpairs::steal( int k, int& t )
+{
+	while( true )
+	{
+		// find the longest range. It may shrink before it is locked
+		// again below, so it is checked again then
+		int victim = -1, longest = 0;
+		for( int v = 0; v < threads_; v++ )
+		{
+			if( v == k )
+			{
+				continue;
+			}
+			pthread_mutex_lock( &ranges_[v].lock_ );
+			int left = ranges_[v].hi_ - ranges_[v].lo_;
+			pthread_mutex_unlock( &ranges_[v].lock_ );
+			if( left > longest )
+			{
+				victim = v;
+				longest = left;
+			}
+		}
+		if( victim < 0 )
+		{
+			return false;
+		}
+
+		int lo = 0, hi = 0;
+		pthread_mutex_lock( &ranges_[victim].lock_ );
+		if( ranges_[victim].lo_ < ranges_[victim].hi_ )
+		{
+			hi = ranges_[victim].hi_;
+			lo = hi - ( hi - ranges_[victim].lo_ + 1 ) / 2;
+			ranges_[victim].hi_ = lo;
+		}
+		pthread_mutex_unlock( &ranges_[victim].lock_ );
+
+		// the range was emptied in the meantime: look again
+		if( lo == hi )
+		{
+			continue;
+		}
+
+		t = lo;
+		pthread_mutex_lock( &ranges_[k].lock_ );
+		ranges_[k].lo_ = lo+1;
+		ranges_[k].hi_ = hi;
+		pthread_mutex_unlock( &ranges_[k].lock_ );
+		return true;
+	}
+}
+
+/******************************************************************************/
+
+// align the pairs of a tile, keeping the significant ones
+
+void allpairs::tile( int t, dynamic& d, worker& w )
+{
+	// a run of whole rows of the list, whose pairs with the same
+	// x-sequence follow each other
+	if( listed_ )
+	{
+		int end = tiles_[t].second;
+		for( int k = tiles_[t].first; k < end; )
+		{
+			int i = list_[k].first;
+			w.row_.clear();
+			for( ; k < end && list_[k].first == i; k++ )
+			{
+				if( filter_ && !filter_->pass( i, list_[k].second ) )
+				{
+					continue;
+				}
+				w.row_.push_back( list_[k].second );
+			}
+			row( i, d, w );
+		}
+		return;
+	}
+
+	int n = static_cast<int>( sequences_.size() );
+	int ibegin = tiles_[t].first * tilesize_;
+	int jbegin = tiles_[t].second * width_;
+	int iend = min( ibegin + tilesize_, rows_ );
+	int jend = min( jbegin + width_, n );
+
+	for( int i = ibegin; i < iend; i++ )
+	{
+		w.row_.clear();
+		for( int j = max( max( jbegin, i+1 ), from_ ); j < jend; j++ )
+		{
+			if( filter_ && !filter_->pass( i, j ) )
+			{
+				continue;
+			}
+			w.row_.push_back( j );
+		}
+		row( i, d, w );
+	}
+}
+
+/******************************************************************************/
+
+// align sequence i against the sequences of a thread's row, keeping the
+//	significant pairs. Unbanded alignments are performed in a batch (see
+//	dynamic.h, 3.6), and banded ones, whose bands differ, one by one.
+
+void allpairs::row( int i, dynamic& d, worker& w )
+{
+	int m = static_cast<int>( w.row_.size() );
+	int k;
+
+	if( bandwidth_ >= 0 )
+	{
+		for( k = 0; k < m; k++ )
+		{
+			int j = w.row_[k];
+			banding( i, j, d );
+			d.input( sequences_[i], sequences_[j], true );
+			if( d.significant() )
+			{
+				w.edges_.push_back( pair<int, int>( i, j ) );
+			}
+			w.cells_ += d.cells();
+			w.stopped_ += d.stopped();
+			w.abandoned_ += d.abandoned();
+		}
+		w.alignments_ += m;
+		return;
+	}
+
+	w.ys_.resize( m );
+	for( k = 0; k < m; k++ )
+	{
+		w.ys_[k] = &sequences_[ w.row_[k] ];
+	}
+	d.batch( sequences_[i], w.ys_, w.scores_, true );
+	w.cells_ += d.cells();
+	w.stopped_ += d.stopped();
+	w.abandoned_ += d.abandoned();
+	for( k = 0; k < m; k++ )
+	{
+		if( d.significant( w.scores_[k] ) )
+		{
+			w.edges_.push_back( pair<int, int>( i, w.row_[k] ) );
+		}
+	}
+	w.alignments_ += m;
+}
+
+/******************************************************************************/
+
+// center the band of the alignment of sequences i and j on the diagonal of
+//	their shared k-mers, or lift it if there is none
+
+void allpairs::banding( int i, int j, dynamic& d ) const
+{
+	int diagonal;
+
+	if( bandwidth_ >= 0 && filter_ && filter_->diagonal( i, j, diagonal ) )
+	{
+		d.band( diagonal, bandwidth_ );
+	}
+	else
+	{
+		d.unband();
+	}
+}
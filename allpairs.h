@@ -0,0 +1,232 @@
+	/*
+File:		allpairs.h
+Title:		Class declaration for class "allpairs", a multithreaded engine
+		aligning all the pairs of a set of sequences.
+
+Description:
+
+1. OVERVIEW
+
+	The allpairs class aligns every pair (i, j), i < j, of a vector of dna
+sequences, or a given list of pairs, and keeps the pairs whose alignment is
+significant (the "edges" of the similarity graph used by exest and gaest).
+The alignments are performed by several threads (POSIX threads), each of
+which has its own score-only dynamic object (see dynamic.h) as a workspace.
+
+2. DATA MEMBERS
+
+	2.1. TILES
+
+	The triangle of pairs is divided into tiles of TILE rows (fewer on the
+diagonal of the triangle). Within a tile, the x-sequence changes only once per
+row, so the query profile of the vectorized kernel is reused (see striped.h),
+and the sequences of the tile are likely to stay in the processor caches. The
+pairs of each row of a tile are given together to the batch alignment of
+dynamic (see dynamic.h, 3.6), unless they are banded. Since it aligns rows of
+fewer than DYNBATCH targets one by one, unbanded tiles are made as many times
+TILE columns wide as it takes to reach DYNBATCH; banded tiles are square.
+
+	When a list of pairs is aligned instead, the list is sorted and each
+tile is a run of at least TILE consecutive pairs of it, which is only cut
+between two x-sequences: all the pairs of an x-sequence (e.g. the pending
+pairs of gaest) are in the same tile, and are given to the batch alignment
+together.
+
+	2.2. DEVICE
+
+	If a device is given (see device.h), the pairs of the tiles that pass
+the prefilter are aligned on it instead, DEVICEPAIRS at a time, after the
+sequences have been uploaded once. The pairs it can not align are then
+aligned by the threads as a list. Nothing is aligned on the device with a
+band, with scores that are not integral, or if it fails, in which case all the
+pairs are aligned by the threads.
+
+	2.3. WORK STEALING
+
+	The tiles are numbered row by row, and each thread starts with an equal
+contiguous range of tile numbers. A thread takes tiles from the front of its
+own range. When its range is empty, it looks for the thread with the longest
+remaining range and steals the back half of it. Each range is protected by its
+own mutex, which is only held for the few instructions needed to take or
+steal tiles, so the threads rarely wait for each other and the throughput
+grows almost linearly with the number of threads.
+
+	2.4. EDGES
+
+	Each thread writes the significant pairs it finds into its own buffer.
+The buffers are merged, and the edges sorted, when all the threads are done,
+so the result does not depend on the number of threads or on the order in
+which the tiles were processed. Only the significant pairs are kept, so their
+memory grows with their number and not with the square of the number of
+sequences; exest builds its graph of clusters (see clusters.h) from them
+directly.
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR
+
+	The constructor takes the sequences to align, a dynamic object with the
+rewards, penalties and significance to use (it is copied by each thread), the
+number of threads, and the tile size. A number of threads of 0 or less uses
+one thread per online processor.
+
+	3.2. OTHER FUNCTIONS
+
+		- run(): aligns all the pairs. Can be called again after the
+	sequences have changed. If a first index is given, only the pairs
+	(i, j) with j at least that index are aligned, i.e. those involving
+	the sequences added since a previous run (see clusterstate.h). If a
+	number of rows is also given, only the pairs (i, j) with i less than
+	that number are aligned, e.g. those between the sequences of two sets
+	put one after the other (see mpiest.cpp). If a list of pairs is given,
+	only those pairs are aligned (duplicates are aligned once).
+		- edges(): the significant pairs found by the last run(), sorted.
+	They are (i, j) with i < j, unless the pairs of the list were given
+	the other way around.
+		- alignments(): the number of alignments performed by the last
+	run().
+		- cells(), stopped(), abandoned(): the cells computed by the
+	alignments of the last run() on the CPU, and the number of them that
+	stopped at significance or were abandoned in X-drop mode before their
+	last cell (see dynamic.h). The device does not report them.
+		- filter(): sets a k-mer prefilter (see kmer.h). The pairs it
+	rejects are not aligned, and are not counted by alignments(). A null
+	pointer (the default) aligns every pair.
+		- band(): aligns each pair in a band of the given width around
+	the diagonal of its shared k-mers (see dynamic.h), which requires a
+	prefilter. Pairs without a diagonal, and all pairs if the width is
+	negative (DYNNOBAND, the default), are aligned without a band.
+		- offload(): aligns the pairs on a device (see 2.2). A null
+	pointer (the default) aligns them all on the CPU.
+		- offloaded(): the number of alignments performed on the device
+	by the last run().
+		- threads(): the number of threads used.
+		- processors(): the number of online processors.
+
+4. NOTES
+
+	The dna objects are only read during run(), and each thread has its own
+dynamic object, so no locking is needed around the alignments themselves.
+
+	*/
+
+#ifndef ALLPAIRS_H
+#define ALLPAIRS_H
+
+#include <vector>
+#include <utility>
+#include <pthread.h>
+#include "dna.h"
+#include "dynamic.h"
+#include "kmer.h"
+#include "device.h"
+
+const int ALLTILE = 64;		// default tile size (sequences per side)
+
+class allpairs
+{
+	public:
+		// constructor and destructor
+		allpairs( vector<dna>&, const dynamic&, int t = 0,
+			int ts = ALLTILE );
+		~allpairs();
+
+		// "get" functions
+		const vector< pair<int, int> >& edges( void ) const
+			{ return edges_; }
+		double alignments( void ) const { return alignments_; }
+		double offloaded( void ) const { return offloaded_; }
+		double cells( void ) const { return cells_; }
+		double stopped( void ) const { return stopped_; }
+		double abandoned( void ) const { return abandoned_; }
+		int threads( void ) const { return threads_; }
+		static int processors( void );
+
+		// "set" functions
+		void filter( const kmers* f ) { filter_ = f; }
+		void band( int w ) { bandwidth_ = w; }
+		void offload( device* g ) { device_ = g; }
+
+		// other functions
+		void run( int from = 0, int rows = -1 );
+		void run( const vector< pair<int, int> >& );
+
+	private:
+		// a range of tile numbers, owned by one thread
+		struct tilerange
+		{
+			pthread_mutex_t lock_;
+			int lo_, hi_;
+		};
+
+		// the state of one thread
+		struct worker
+		{
+			allpairs* engine_;
+			int id_;
+			vector< pair<int, int> > edges_;
+			double alignments_;
+			double cells_, stopped_, abandoned_;
+
+			// the row being aligned, and its scores
+			vector<int> row_;
+			vector<dna*> ys_;
+			vector<float> scores_;
+		};
+
+		// thread entry point, and its loop
+		static void* start( void* );
+		void work( worker& );
+
+		// take a tile from the own range, or steal one
+		bool take( int, int& );
+		bool steal( int, int& );
+
+		// cut the list into tiles of whole rows
+		int cut( void );
+
+		// distribute a number of tiles to the threads and run them
+		void dispatch( int );
+
+		// align the pairs of a number of tiles on the device, leaving
+		// those it can not align in the list
+		bool ondevice( int );
+
+		// align the pairs of a tile, one row of it at a time
+		void tile( int, dynamic&, worker& );
+		void row( int, dynamic&, worker& );
+
+		// set the band of the alignment of a pair
+		void banding( int, int, dynamic& ) const;
+
+		// no copying
+		allpairs( const allpairs& );
+		allpairs& operator=( const allpairs& );
+
+		vector<dna>& sequences_;	// the sequences to align
+		const dynamic& proto_;	// the alignment parameters
+		int threads_;		// the number of threads
+		int tilesize_;		// the size of a tile
+		int width_;		// the columns of a tile of the triangle
+		const kmers* filter_;	// the prefilter, if any
+		int bandwidth_;		// the width of the bands
+		device* device_;	// the device, if any
+
+		vector< pair<int, int> > tiles_;
+					// the (row, column) of each tile, or
+					// its range of the list
+		vector< pair<int, int> > list_;	// the pairs to align, if not
+		bool listed_;			// all of them
+		int from_;		// the first y-sequence to align
+		int rows_;		// the x-sequences to align
+		vector<tilerange> ranges_;	// the tiles left to each thread
+
+		vector< pair<int, int> > edges_;	// the significant pairs
+		double alignments_;	// the number of alignments performed
+		double offloaded_;	// of which on the device
+		double cells_;		// the cells they computed on the CPU
+		double stopped_;	// and how many of them stopped at
+		double abandoned_;	// significance or were abandoned
+};
+
+#endif
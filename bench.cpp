@@ -0,0 +1,815 @@
+	/*
+File:		bench.cpp
+Title:		Benchmarks of the alignment kernels, the input, the cache and the
+		objective of gaest
+
+Description:	Measures the speed of the parts of gaest and exest that take
+		most of their time, on synthetic ESTs or on those of a FASTA
+		file, and prints the results to stdout as tab-separated
+		values: one line per measure, with the benchmark, the
+		variant, the metric and its value.
+
+		Type -h for command-line descriptions.
+
+		See end of this file for implementation details.
+
+		Modules needed: dna.h, dna.cpp, dynamic.h, dynamic.cpp,
+		striped.h, striped.cpp, device.h, device.cu, cache.h,
+		cache.cpp, kmer.h, kmer.cpp, fasta.h, fasta.cpp, seqstore.h,
+		seqstore.cpp, clustergenome.h, clustergenome.cpp. GAlib and
+		POSIX threads must be installed.
+
+	*/
+
+/******************************************************************************/
+
+// imported files, symbolic constants
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <time.h>
+#include <unistd.h>
+#include <ga/ga.h>
+#include "dna.h"
+#include "dynamic.h"
+#include "striped.h"
+#include "device.h"
+#include "cache.h"
+#include "kmer.h"
+#include "fasta.h"
+#include "seqstore.h"
+#include "clustergenome.h"
+
+// default values for some program parameters
+const int BENCHSEQS = 400;	// the number of synthetic ESTs
+const int BENCHLENGTH = 500;	// their mean length
+const double BENCHTIME = 0.5;	// the least time of a measure, in seconds
+const char* BENCHFILE = "/tmp/benchXXXXXX";	// the template of the name of
+						// the file of synthetic ESTs
+
+// the synthetic ESTs (see A. below)
+const int BENCHFAMILY = 4;	// the most ESTs of a transcript
+const double BENCHERROR = 0.02;	// their rate of sequencing errors
+const unsigned int BENCHSEED = 1;	// the seed of the random numbers
+
+// the other parameters of the measures
+const int BENCHBAND = 20;	// the width of the band
+const float BENCHXTND = -0.2001;	// a gap extension penalty that is not
+					// integral once scaled (see dynamic.h)
+const int BENCHDRAWS = 50;	// the pairs drawn per sequence from the cache
+const int BENCHGENOMES = 10;	// the population evaluated by objective()
+const float BENCHMUTATION = 0.01;	// the rate of its mutations
+
+/******************************************************************************/
+
+// declaration of user-defined functions for use with the GA
+
+float objective( GAGenome& );
+
+// declaration of "helper" functions
+
+string synthesize( int, int );
+void benchinput( const string& );
+void benchalign( const string&, dynamic&, bool, bool,
+	const vector< pair<int, int> >& );
+void benchbatch( const string&, dynamic&, bool, const vector<int>& );
+void benchdevice( void );
+void benchcache( void );
+void benchobjective( void );
+bool edge( int, int );
+double now( void );
+void report( const string&, const string&, const string&, double );
+void error( const string&, const string& );
+
+// declaration of global variables: the sequences, views of a store keeping them
+// (see seqstore.h), the pairs aligned (see B. below), those of them aligned by
+// the kernel of the bases and by that of the full scale (see dynamic.h, 3.7),
+// the sequences made of bases and the others, the k-mer lists (for the bands
+// and the edges of objective()), the cache of the edges, and the least time of
+// a measure
+seqstore store;
+vector<dna> sequences;
+vector< pair<int, int> > pairs, bpairs, fpairs;
+vector<int> bsequences, fsequences;
+kmers sketches;
+cache scores;
+double mintime = BENCHTIME;
+
+/******************************************************************************/
+
+// main program
+
+int main( int argc, char** argv )
+{
+	// the number and mean length of the synthetic ESTs, and the FASTA file
+	// of real ones, if any
+	int n = BENCHSEQS;
+	int length = BENCHLENGTH;
+	string file;
+
+	const string errormsg( "Incorrect option syntax. Use -h for help." );
+	const string usage( "\nBenchmarks. Measure the speed of the alignment "
+		"kernels, of the input, of the\ncache and of the objective of "
+		"gaest, on synthetic ESTs or on those of a\nFASTA file, and "
+		"print the results to stdout as tab-separated values.\n"
+		"Usage: bench [options] [file]\n\n"
+		"Available options:\n"
+		"\t-n int:\t\tspecify the number of synthetic ESTs\n"
+			"\t\t\t(default 400).\n"
+		"\t-length int:\tspecify their mean length (default 500).\n"
+		"\t-time float:\tspecify the least time of a measure, in\n"
+			"\t\t\tseconds (default 0.5).\n"
+		"\t-h(elp):\tprint this message.\n"
+		);
+
+	for( int i = 1; i < argc; i++ )
+	{
+		string opt( argv[i] );
+
+		// set the number of synthetic ESTs
+		if( opt == "-n" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				n = atoi( argv[i] );
+				if( n < 2 )
+				{
+					error( argv[0], errormsg );
+				}
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// set their mean length
+		if( opt == "-length" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				length = atoi( argv[i] );
+				if( length < 2 * DYNSIG )
+				{
+					error( argv[0], errormsg );
+				}
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// set the least time of a measure
+		if( opt == "-time" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				mintime = atof( argv[i] );
+				if( mintime <= 0 )
+				{
+					error( argv[0], errormsg );
+				}
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// print a help message
+		if( opt == "-h" || opt == "-help" )
+		{
+			cout	<< argv[0] << ": " << endl << usage << endl;
+			return 0;
+		}
+
+		// the FASTA file
+		if( opt[0] != '-' && file.empty() )
+		{
+			file = opt;
+			continue;
+		}
+
+		error( argv[0], errormsg );
+	}
+
+	// write the synthetic ESTs, if there is no file of real ones
+	bool synthetic = file.empty();
+	if( synthetic )
+	{
+		file = synthesize( n, length );
+	}
+
+	cout	<< "benchmark\tvariant\tmetric\tvalue" << endl;
+	benchinput( file );
+
+	fasta input( file );
+	if( !input.good() )
+	{
+		error( argv[0], "ERROR: Input could not be read. Program "
+			"terminated." );
+	}
+	input.read( store );
+	store.views( sequences );
+	if( synthetic )
+	{
+		remove( file.c_str() );
+	}
+	n = static_cast<int>( sequences.size() );
+	if( n < 2 )
+	{
+		error( argv[0], "ERROR: At least two sequences are needed. "
+			"Program terminated." );
+	}
+	report( "input", synthetic ? "synthetic" : "file", "sequences", n );
+
+	// every sequence with the next one (often related) and with another
+	// one at random (almost never related)
+	srand( BENCHSEED );
+	for( int i = 0; i < n; i++ )
+	{
+		int j = rand() % n;
+		pairs.push_back( pair<int, int>( i, ( i + 1 ) % n ) );
+		if( j != i )
+		{
+			pairs.push_back( pair<int, int>( i, j ) );
+		}
+	}
+	for( int p = 0; p < static_cast<int>( pairs.size() ); p++ )
+	{
+		if( sequences[ pairs[p].first ].bases()
+			&& sequences[ pairs[p].second ].bases() )
+		{
+			bpairs.push_back( pairs[p] );
+		}
+		else
+		{
+			fpairs.push_back( pairs[p] );
+		}
+	}
+	for( int i = 0; i < n; i++ )
+	{
+		if( sequences[i].bases() )
+		{
+			bsequences.push_back( i );
+		}
+		else
+		{
+			fsequences.push_back( i );
+		}
+	}
+	report( "align", "bases", "pairs", bpairs.size() );
+	report( "align", "fullscale", "pairs", fpairs.size() );
+	sketches.build( sequences );
+
+	// the alignment kernels (see B. below), each of the striped ones on
+	// the pairs of the bases and on the others
+	string isa( striped::available() ? striped::isa() : "none" );
+	dynamic full( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, DYNGAPXTND, DYNSIG,
+		DYNFULL );
+	dynamic scalar( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, BENCHXTND, DYNSIG,
+		DYNSCORE );
+	dynamic score( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, DYNGAPXTND, DYNSIG,
+		DYNSCORE );
+	dynamic xdrop( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, DYNGAPXTND, DYNSIG,
+		DYNSCORE, 0 );
+	benchalign( "full", full, false, false, pairs );
+	benchalign( "scalar", scalar, false, false, pairs );
+	for( int b = 1; b >= 0; b-- )
+	{
+		const vector< pair<int, int> >& list = b ? bpairs : fpairs;
+		string scale( b ? "-bases" : "-fullscale" );
+		benchalign( "striped-" + isa + scale, score, false, false,
+			list );
+		benchalign( "striped-" + isa + "-stop" + scale, score, true,
+			false, list );
+		benchalign( "xdrop-" + isa + scale, xdrop, true, false, list );
+	}
+	benchalign( "band", score, true, true, pairs );
+	for( int b = 1; b >= 0; b-- )
+	{
+		const vector<int>& queries = b ? bsequences : fsequences;
+		string scale( b ? "-bases" : "-fullscale" );
+		benchbatch( "batch-" + isa + scale, score, false, queries );
+		benchbatch( "batch-" + isa + "-stop" + scale, score, true,
+			queries );
+	}
+	benchdevice();
+
+	benchcache();
+	benchobjective();
+
+	return 0;
+}
+
+/******************************************************************************/
+
+float objective( GAGenome& g )
+{
+	clustergenome& genome = static_cast< clustergenome& > (g);
+	return genome.fitness();
+}
+
+/******************************************************************************/
+
+// write n synthetic ESTs of a mean length to a new temporary FASTA file (see
+//	A. below), those of every other transcript with ambiguous nucleotides,
+//	and return its name
+
+string synthesize( int n, int length )
+{
+	// the file is created by mkstemp(), so that no file of the user is
+	// overwritten
+	string file( BENCHFILE );
+	int fd = mkstemp( &file[0] );
+	if( fd >= 0 )
+	{
+		close( fd );
+	}
+	ofstream out( file.c_str(), ios::out | ios::trunc );
+	if( fd < 0 || !out.good() )
+	{
+		if( fd >= 0 )
+		{
+			remove( file.c_str() );
+		}
+		error( "bench", "ERROR: Synthetic ESTs could not be written. "
+			"Program terminated." );
+	}
+
+	const char bases[] = "ACGT";
+	srand( BENCHSEED );
+	string transcript, est;
+	for( int s = 0, family = 0; s < n; family++ )
+	{
+		transcript.resize( 2 * length );
+		for( int p = 0; p < 2 * length; p++ )
+		{
+			transcript[p] = bases[ rand() % 4 ];
+		}
+
+		for( int e = rand() % BENCHFAMILY; e >= 0 && s < n; e--, s++ )
+		{
+			int begin = rand() % ( length / 2 );
+			int size = length / 2 + rand() % length;
+			est.assign( transcript, begin, size );
+			for( int p = 0; p < size; p++ )
+			{
+				if( rand() < BENCHERROR * RAND_MAX )
+				{
+					est[p] = bases[ rand() % 4 ];
+				}
+				if( family % 2 && rand() < BENCHERROR * RAND_MAX )
+				{
+					est[p] = 'N';
+				}
+			}
+
+			out	<< ">est" << s << " transcript " << family
+				<< endl;
+			for( int p = 0; p < size; p += DYNWRAP )
+			{
+				out	<< est.substr( p, DYNWRAP ) << endl;
+			}
+		}
+	}
+	if( !out.good() )
+	{
+		remove( file.c_str() );
+		error( "bench", "ERROR: Synthetic ESTs could not be written. "
+			"Program terminated." );
+	}
+	return file;
+}
+
+/******************************************************************************/
+
+// read a FASTA file into a store, parsing and packing all the sequences
+
+void benchinput( const string& file )
+{
+	double bytes = 0, count = 0, start = now(), elapsed;
+	do
+	{
+		fasta input( file );
+		if( !input.good() )
+		{
+			error( "bench", "ERROR: Input could not be read. "
+				"Program terminated." );
+		}
+		seqstore s;
+		count += input.read( s );
+		bytes += input.bytes();
+	}
+	while( ( elapsed = now() - start ) < mintime );
+
+	report( "input", "fasta", "MB/s", bytes / elapsed / 1e6 );
+	report( "input", "fasta", "sequences/s", count / elapsed );
+}
+
+/******************************************************************************/
+
+// align a list of pairs with a dynamic object, stopping at significance or
+//	not, and in a band around the diagonal of their shared k-mers or not.
+//	The speed is in cells of the full matrices, whether they are all
+//	computed or not. Nothing is reported for an empty list.
+
+void benchalign( const string& variant, dynamic& d, bool stop, bool banded,
+	const vector< pair<int, int> >& list )
+{
+	if( list.empty() )
+	{
+		return;
+	}
+
+	double cells = 0, count = 0, significant = 0, start = now(), elapsed;
+	int diagonal;
+	do
+	{
+		for( int p = 0; p < static_cast<int>( list.size() ); p++ )
+		{
+			dna& x = sequences[ list[p].first ];
+			dna& y = sequences[ list[p].second ];
+			if( banded && sketches.diagonal( list[p].first,
+				list[p].second, diagonal ) )
+			{
+				d.band( diagonal, BENCHBAND );
+			}
+			else
+			{
+				d.unband();
+			}
+			d.input( x, y, stop );
+			cells += static_cast<double>( x.length() ) * y.length();
+			count++;
+			if( d.significant() )
+			{
+				significant++;
+			}
+		}
+	}
+	while( ( elapsed = now() - start ) < mintime );
+
+	report( "align", variant, "GCUPS", cells / elapsed / 1e9 );
+	report( "align", variant, "pairs/s", count / elapsed );
+	report( "align", variant, "significant", significant / count );
+}
+
+/******************************************************************************/
+
+// align every sequence of a list against the next DYNBATCH ones of the list
+//	with batch() (see dynamic.h), one query at a time. A short list is gone
+//	round again (without the query), so that the batch kernel gets enough
+//	targets. Nothing is reported for a list of fewer than two sequences.
+
+void benchbatch( const string& variant, dynamic& d, bool stop,
+	const vector<int>& list )
+{
+	int n = static_cast<int>( list.size() );
+	if( n < 2 )
+	{
+		return;
+	}
+	int width = DYNBATCH;
+	vector<dna*> targets( width );
+	vector<float> results;
+	double cells = 0, count = 0, start = now(), elapsed;
+	int i = 0;
+	d.unband();
+	do
+	{
+		dna& x = sequences[ list[i] ];
+		for( int t = 0; t < width; t++ )
+		{
+			targets[t] = &sequences
+				[ list[ ( i + 1 + t % ( n - 1 ) ) % n ] ];
+			cells += static_cast<double>( x.length() )
+				* targets[t]->length();
+		}
+		d.batch( x, targets, results, stop );
+		count += width;
+		i = ( i + 1 ) % n;
+	}
+	while( ( elapsed = now() - start ) < mintime );
+
+	report( "align", variant, "GCUPS", cells / elapsed / 1e9 );
+	report( "align", variant, "pairs/s", count / elapsed );
+}
+
+/******************************************************************************/
+
+// align the pairs on the CUDA device (see device.h), if there is one
+
+void benchdevice( void )
+{
+	device gpu;
+	dynamic d( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, DYNGAPXTND, DYNSIG,
+		DYNSCORE );
+	if( !gpu.open() || !gpu.scoring( d ) || !gpu.upload( sequences ) )
+	{
+		return;
+	}
+
+	vector< pair<int, int> > edges, rest;
+	double cells = 0, count = 0, start = now(), elapsed;
+	do
+	{
+		edges.clear();
+		rest.clear();
+		if( !gpu.align( pairs, edges, rest ) )
+		{
+			return;
+		}
+		for( int p = 0; p < static_cast<int>( pairs.size() ); p++ )
+		{
+			cells += static_cast<double>( sequences[ pairs[p].first ]
+				.length() ) * sequences[ pairs[p].second ].length();
+		}
+		count += pairs.size() - rest.size();
+	}
+	while( ( elapsed = now() - start ) < mintime );
+
+	report( "align", "device-" + gpu.name(), "GCUPS",
+		cells / elapsed / 1e9 );
+	report( "align", "device-" + gpu.name(), "pairs/s", count / elapsed );
+}
+
+/******************************************************************************/
+
+// draw random pairs like the initializer and the mutator of gaest, looking
+//	each up in the cache and storing the result of those missing, and then
+//	look them all up again. The draws are repeated with a memory budget of
+//	a quarter of the footprint of the first table (see cache.h, 2.3).
+
+void benchcache( void )
+{
+	int n = static_cast<int>( sequences.size() );
+	int draws = BENCHDRAWS * n;
+	vector< pair<int, int> > drawn( draws );
+	srand( BENCHSEED );
+	for( int d = 0; d < draws; d++ )
+	{
+		int i = rand() % n, j = rand() % ( n - 1 );
+		drawn[d] = pair<int, int>( i, ( j >= i ) ? j + 1 : j );
+	}
+
+	cache table;
+	double hits = 0, start = now();
+	for( int d = 0; d < draws; d++ )
+	{
+		if( table.known( drawn[d].first, drawn[d].second ) )
+		{
+			hits++;
+		}
+		else
+		{
+			table.insert( drawn[d].first, drawn[d].second, false );
+		}
+	}
+	double elapsed = now() - start;
+	report( "cache", "draws", "hit rate", hits / draws );
+	report( "cache", "draws", "miss rate", 1 - hits / draws );
+	report( "cache", "draws", "Mops/s", draws / elapsed / 1e6 );
+	report( "cache", "draws", "bytes/entry", table.bytes() / table.size() );
+
+	cache bounded;
+	bounded.budget( table.bytes() / 4 );
+	hits = 0;
+	start = now();
+	for( int d = 0; d < draws; d++ )
+	{
+		if( bounded.known( drawn[d].first, drawn[d].second ) )
+		{
+			hits++;
+		}
+		else
+		{
+			bounded.insert( drawn[d].first, drawn[d].second, false );
+		}
+	}
+	elapsed = now() - start;
+	report( "cache", "budget", "hit rate", hits / draws );
+	report( "cache", "budget", "Mops/s", draws / elapsed / 1e6 );
+	report( "cache", "budget", "bytes", bounded.bytes() );
+	report( "cache", "budget", "evicted", bounded.evicted() );
+
+	double count = 0, found = 0;
+	start = now();
+	do
+	{
+		for( int d = 0; d < draws; d++ )
+		{
+			if( table.known( drawn[d].first, drawn[d].second ) )
+			{
+				found++;
+			}
+		}
+		count += draws;
+	}
+	while( ( elapsed = now() - start ) < mintime );
+	report( "cache", "lookups", "Mops/s", count / elapsed / 1e6 );
+	report( "cache", "lookups", "hit rate", found / count );
+}
+
+/******************************************************************************/
+
+// evaluate genomes of random partners, whose edges are the pairs sharing
+//	enough k-mers: from scratch, and after a mutation (see clustergenome.h)
+
+void benchobjective( void )
+{
+	// objective() only asks for the edges between a sequence and its
+	// partner, so only those of the genomes and of the mutations, drawn in
+	// advance, are stored (all the pairs of a file of real ESTs would not
+	// fit in memory)
+	int n = static_cast<int>( sequences.size() );
+	clustergenome genome( n, objective, edge );
+	vector<clustergenome> population( BENCHGENOMES, genome );
+	vector< pair<int, int> > changes( BENCHDRAWS * n );
+	srand( BENCHSEED );
+	for( int g = 0; g < BENCHGENOMES; g++ )
+	{
+		for( int i = 0; i < n; i++ )
+		{
+			int j = rand() % ( n - 1 );
+			j = ( j >= i ) ? j + 1 : j;
+			population[g].change( i, j );
+			if( !scores.known( i, j ) )
+			{
+				scores.insert( i, j, sketches.pass( i, j ) );
+			}
+		}
+	}
+	for( int c = 0; c < static_cast<int>( changes.size() ); c++ )
+	{
+		int i = rand() % n, j = rand() % ( n - 1 );
+		changes[c] = pair<int, int>( i, ( j >= i ) ? j + 1 : j );
+		if( !scores.known( changes[c].first, changes[c].second ) )
+		{
+			scores.insert( changes[c].first, changes[c].second,
+				sketches.pass( changes[c].first, changes[c].second ) );
+		}
+	}
+
+	double count = 0, fitness = 0, start = now(), elapsed;
+	do
+	{
+		for( int g = 0; g < BENCHGENOMES; g++ )
+		{
+			population[g].invalidate();
+			fitness += population[g].fitness();
+		}
+		count += BENCHGENOMES;
+	}
+	while( ( elapsed = now() - start ) < mintime );
+	report( "objective", "rebuild", "us/genome", elapsed / count * 1e6 );
+	report( "objective", "rebuild", "score", fitness / count );
+
+	int mutations = static_cast<int>( ceil( BENCHMUTATION * n ) );
+	int next = 0;
+	count = 0;
+	start = now();
+	do
+	{
+		for( int g = 0; g < BENCHGENOMES; g++ )
+		{
+			for( int m = 0; m < mutations; m++ )
+			{
+				population[g].change( changes[next].first,
+					changes[next].second );
+				next = ( next + 1 )
+					% static_cast<int>( changes.size() );
+			}
+			population[g].fitness();
+		}
+		count += BENCHGENOMES;
+	}
+	while( ( elapsed = now() - start ) < mintime );
+	report( "objective", "mutation", "us/genome", elapsed / count * 1e6 );
+}
+
+/******************************************************************************/
+
+// are two sequences joined, for objective()?
+
+bool edge( int i, int j )
+{
+	return scores.edge( i, j );
+}
+
+/******************************************************************************/
+
+// the time, in seconds, on a clock that never goes back
+
+double now( void )
+{
+	timespec t;
+	clock_gettime( CLOCK_MONOTONIC, &t );
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/******************************************************************************/
+
+// print a measure, as a line of tab-separated values
+
+void report( const string& benchmark, const string& variant,
+	const string& metric, double value )
+{
+	cout	<< benchmark << "\t" << variant << "\t" << metric << "\t"
+		<< value << endl;
+}
+
+/******************************************************************************/
+
+// print an error message and exit
+
+void error( const string& progname, const string& errormsg )
+{
+	cerr	<< progname << ": " << errormsg << endl;
+	exit( EXIT_FAILURE );
+}
+
+/******************************************************************************/
+
+/*
+			INFORMATION ON THE IMPLEMENTATION
+
+A. Fixtures
+
+		Without a FASTA file, bench writes synthetic ESTs to a new file
+	named after BENCHFILE by mkstemp(), reads them back, and removes the
+	file. They are drawn from random transcripts of twice the mean length,
+	each giving 1 to BENCHFAMILY ESTs of half to one and a half times the
+	mean length, at random offsets in its first half, with a rate
+	BENCHERROR of substitutions. Those of every other transcript also have
+	a rate BENCHERROR of Ns, like reads of a lower quality, so that both
+	kernels of dynamic are measured: the pairs of sequences of bases only
+	are aligned by the kernel of the bases, and the others by that of the
+	full scale (see dynamic.h, 3.7). The ESTs of a transcript are
+	consecutive, and mostly overlap enough to be significantly similar,
+	like those of a library, and those of different transcripts are
+	unrelated. With a FASTA
+	file (real ESTs), its sequences are used instead. The random numbers
+	always start from BENCHSEED, so the fixtures and the pairs are the same
+	from run to run.
+
+B. Measures
+
+		Every measure is repeated until it has taken at least mintime
+	seconds (see -time), and then its speed is that of all of the
+	repetitions.
+
+		- input: the file read into a store by fasta (see fasta.h), in
+	megabytes and sequences per second.
+		- align: every sequence aligned against the next one and
+	against one at random, in billions of cells per second (GCUPS) and
+	pairs per second. The cells are those of the full matrices, so the
+	variants that stop early (at significance or with X-drop) or compute
+	only a band are credited with all of them, and the GCUPS compare the
+	variants on the same pairs. The variants are the alignment with the
+	full matrices (DYNFULL), the scalar score-only alignment (scores that
+	are not integral once scaled, BENCHXTND, keep it from using the
+	kernel), the striped kernel of the CPU (see striped.h) with and
+	without stopping at significance, X-drop and the band around the
+	diagonal of the shared k-mers (see dynamic.h), batches of DYNBATCH
+	targets (see dynamic.h, 3.6) and the CUDA device, if there is one
+	(see device.h). The striped, X-drop and batch variants are measured
+	apart on the pairs of bases (-bases) and on the others (-fullscale),
+	whose numbers are reported first, since the two kernels differ in
+	width and speed; the batches of each are those of its sequences. The
+	fraction of the pairs found significant tells whether a faster
+	variant has missed any (those of the two kernels, weighted by their
+	numbers of pairs, add up to that of the others).
+		- cache: BENCHDRAWS pairs drawn at random per sequence, as the
+	initializer and the mutator of gaest draw them, looked up in an empty
+	cache (see cache.h) and stored if missing: the rates of hits and misses
+	of the draws (those of gaest without the k-mer index), their speed, and
+	the memory per entry; then the speed of looking them all up again.
+		- objective: the evaluation of BENCHGENOMES genomes of random
+	partners (see clustergenome.h), rebuilding all their clusters and after
+	a mutation of a fraction BENCHMUTATION of their genes, in microseconds
+	per genome. Their edges are the pairs sharing enough k-mers (see
+	kmer.h), which are much faster to find than the significant pairs and
+	make clusters of about the same sizes. The mutations are a cycle of
+	BENCHDRAWS per sequence drawn in advance, and only the edges of the
+	partners of the genomes and of the mutations are stored, so that the
+	setup stays linear in the number of sequences.
+
+		The output has a header line and then one line per measure, with
+	4 tab-separated columns, so that the results of two builds, or of two
+	machines, can be compared by a script.
+
+									      */
@@ -0,0 +1,334 @@
+	/*
+File:		cache.cpp
+Title:		Class definitions for class "cache" (declared in cache.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <vector>
+#include <pthread.h>
+#include "cache.h"
+
+// the reference bit of a slot (see cache.h, 2.3), the bit holding the result,
+//	and the bits holding the key
+const cacheword CACHEREFERENCE = 1ULL << 63;
+const cacheword CACHERESULT = 1ULL << 62;
+const cacheword CACHEKEY = CACHERESULT - 1;
+
+/******************************************************************************/
+
+// constructor for class cache
+
+cache::cache( double l )
+	:
+	budget_( CACHENOBUDGET )
+{
+	load( l );
+	for( int s = 0; s < CACHESHARDS; s++ )
+	{
+		pthread_mutex_init( &shards_[s].lock_, NULL );
+		shards_[s].slots_.resize( CACHESLOTS, 0 );
+		shards_[s].count_ = 0;
+		shards_[s].hand_ = 0;
+		shards_[s].evicted_ = 0;
+	}
+}
+
+/******************************************************************************/
+
+// destructor for class cache
+
+cache::~cache()
+{
+	for( int s = 0; s < CACHESHARDS; s++ )
+	{
+		pthread_mutex_destroy( &shards_[s].lock_ );
+	}
+}
+
+/******************************************************************************/
+
+// the key of a pair: the smaller index in the high 31 bits, the larger one in
+//	the low 31 bits
+
+cacheword cache::key( int i, int j )
+{
+	if( i > j )
+	{
+		int t = i;
+		i = j;
+		j = t;
+	}
+	return ( static_cast<cacheword>( i ) << 31 )
+		| static_cast<cacheword>( j );
+}
+
+/******************************************************************************/
+
+// hash of a key (the finalizer of MurmurHash3, which mixes every bit of the
+//	key into every bit of the hash)
+
+cacheword cache::hash( cacheword k )
+{
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ULL;
+	k ^= k >> 33;
+	return k;
+}
+
+/******************************************************************************/
+
+// find the slot holding a key, or the empty slot where it should be inserted.
+//	The shard is never full (see insert()), so the loop always ends.
+
+int cache::probe( const shard& sh, cacheword k, cacheword h )
+{
+	int mask = static_cast<int>( sh.slots_.size() ) - 1;
+	int slot = static_cast<int>( h ) & mask;
+
+	while( sh.slots_[slot] != 0 && ( sh.slots_[slot] & CACHEKEY ) != k )
+	{
+		slot = ( slot + 1 ) & mask;
+	}
+	return slot;
+}
+
+/******************************************************************************/
+
+// look up the result of a pair, and mark it as referenced
+
+int cache::find( int i, int j ) const
+{
+	cacheword k = key( i, j ), h = hash( k );
+	const shard& sh = shards_[ h >> ( 64 - CACHESHARDBITS ) ];
+	int result = CACHEMISS;
+
+	pthread_mutex_lock( &sh.lock_ );
+	cacheword& slot = sh.slots_[ probe( sh, k, h ) ];
+	if( slot != 0 )
+	{
+		result = ( slot & CACHERESULT ) ? CACHEYES : CACHENO;
+		slot |= CACHEREFERENCE;
+	}
+	pthread_mutex_unlock( &sh.lock_ );
+
+	return result;
+}
+
+/******************************************************************************/
+
+// store the result of a pair (new entries start referenced, so that the hand
+//	of the clock passes them once before they can be evicted)
+
+void cache::insert( int i, int j, bool s )
+{
+	cacheword k = key( i, j ), h = hash( k );
+	shard& sh = shards_[ h >> ( 64 - CACHESHARDBITS ) ];
+
+	pthread_mutex_lock( &sh.lock_ );
+	int slot = probe( sh, k, h );
+	if( sh.slots_[slot] == 0 )
+	{
+		// make room first if the new entry would exceed the maximum
+		// load: by growing the shard, or by evicting an entry if it
+		// has reached its share of the budget
+		if( sh.count_ + 1 > load_ * sh.slots_.size() )
+		{
+			if( growable( sh ) || !evict( sh ) )
+			{
+				grow( sh );
+			}
+			slot = probe( sh, k, h );
+		}
+		sh.count_++;
+	}
+	sh.slots_[slot] = k | ( s ? CACHERESULT : 0 ) | CACHEREFERENCE;
+	pthread_mutex_unlock( &sh.lock_ );
+}
+
+/******************************************************************************/
+
+// double the number of slots of a shard, and reinsert its entries (the lock
+//	of the shard must be held)
+
+void cache::grow( shard& sh )
+{
+	vector<cacheword> old( sh.slots_.size() * 2, 0 );
+	old.swap( sh.slots_ );
+
+	for( vector<cacheword>::const_iterator pos = old.begin();
+		pos != old.end(); pos++ )
+	{
+		if( *pos != 0 )
+		{
+			cacheword k = *pos & CACHEKEY;
+			sh.slots_[ probe( sh, k, hash( k ) ) ] = *pos;
+		}
+	}
+}
+
+/******************************************************************************/
+
+// may a shard double its number of slots without exceeding its share of the
+//	budget?
+
+bool cache::growable( const shard& sh ) const
+{
+	return budget_ <= CACHENOBUDGET || 2 * sh.slots_.size()
+		* sizeof( cacheword ) <= budget_ / CACHESHARDS;
+}
+
+/******************************************************************************/
+
+// evict an entry of a shard with the clock algorithm (see cache.h, 2.3): sweep
+//	the slots from the hand, clearing the reference bits of the entries
+//	that are not significant, and remove the first one found cleared. Two
+//	turns are enough, the first one clearing every bit. Returns false if
+//	every entry is significant (the lock of the shard must be held).
+
+bool cache::evict( shard& sh )
+{
+	int size = static_cast<int>( sh.slots_.size() );
+
+	for( int turn = 0; turn < 2 * size; turn++ )
+	{
+		int slot = sh.hand_;
+		sh.hand_ = ( sh.hand_ + 1 ) & ( size - 1 );
+
+		cacheword& entry = sh.slots_[slot];
+		if( entry == 0 || ( entry & CACHERESULT ) )
+		{
+			continue;
+		}
+		if( entry & CACHEREFERENCE )
+		{
+			entry &= ~CACHEREFERENCE;
+			continue;
+		}
+
+		remove( sh, slot );
+		sh.count_--;
+		sh.evicted_++;
+		return true;
+	}
+	return false;
+}
+
+/******************************************************************************/
+
+// empty a slot, shifting back the entries after it in the same run of slots
+//	which may move into the hole: those whose home slot (the first one they
+//	probe) is not between the hole and their slot. The probes of the other
+//	entries of the run still find them.
+
+void cache::remove( shard& sh, int slot )
+{
+	int mask = static_cast<int>( sh.slots_.size() ) - 1;
+	int hole = slot;
+
+	for( int next = ( hole + 1 ) & mask; sh.slots_[next] != 0;
+		next = ( next + 1 ) & mask )
+	{
+		int home = static_cast<int>( hash( sh.slots_[next] & CACHEKEY ) )
+			& mask;
+		if( ( ( next - home ) & mask ) >= ( ( next - hole ) & mask ) )
+		{
+			sh.slots_[hole] = sh.slots_[next];
+			hole = next;
+		}
+	}
+	sh.slots_[hole] = 0;
+}
+
+/******************************************************************************/
+
+// set the maximum load of the shards
+
+void cache::load( double l )
+{
+	load_ = ( l > 0 && l < CACHEMAXLOAD ) ? l : CACHEMAXLOAD;
+}
+
+/******************************************************************************/
+
+// set the memory budget of the table (only the shards filling up from then on
+//	are affected: none is shrunk)
+
+void cache::budget( double bytes )
+{
+	budget_ = ( bytes > 0 ) ? bytes : CACHENOBUDGET;
+}
+
+/******************************************************************************/
+
+// size the shards for an expected number of entries, within the budget
+
+void cache::reserve( double entries )
+{
+	// the slots needed by each shard at the maximum load
+	double needed = entries / CACHESHARDS / load_;
+
+	for( int s = 0; s < CACHESHARDS; s++ )
+	{
+		pthread_mutex_lock( &shards_[s].lock_ );
+		while( shards_[s].slots_.size() < needed
+			&& growable( shards_[s] ) )
+		{
+			grow( shards_[s] );
+		}
+		pthread_mutex_unlock( &shards_[s].lock_ );
+	}
+}
+
+/******************************************************************************/
+
+// the number of entries in the table
+
+double cache::size( void ) const
+{
+	double total = 0;
+
+	for( int s = 0; s < CACHESHARDS; s++ )
+	{
+		pthread_mutex_lock( &shards_[s].lock_ );
+		total += shards_[s].count_;
+		pthread_mutex_unlock( &shards_[s].lock_ );
+	}
+	return total;
+}
+
+/******************************************************************************/
+
+// the number of slots in the table
+
+double cache::capacity( void ) const
+{
+	double total = 0;
+
+	for( int s = 0; s < CACHESHARDS; s++ )
+	{
+		pthread_mutex_lock( &shards_[s].lock_ );
+		total += shards_[s].slots_.size();
+		pthread_mutex_unlock( &shards_[s].lock_ );
+	}
+	return total;
+}
+
+/******************************************************************************/
+
+// the number of entries evicted from the table
+
+double cache::evicted( void ) const
+{
+	double total = 0;
+
+	for( int s = 0; s < CACHESHARDS; s++ )
+	{
+		pthread_mutex_lock( &shards_[s].lock_ );
+		total += shards_[s].evicted_;
+		pthread_mutex_unlock( &shards_[s].lock_ );
+	}
+	return total;
+}
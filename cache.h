@@ -0,0 +1,174 @@
+	/*
+File:		cache.h
+Title:		Class declaration for class "cache", a thread-safe table of
+		alignment results.
+
+Description:
+
+1. OVERVIEW
+
+	The cache class stores whether two sequences (given by their indices)
+are significantly similar, once their alignment has been computed. It replaces
+the vector of hash tables previously used by gaest, which stored every result
+twice (for (i, j) and (j, i)) in chained buckets.
+
+2. DATA MEMBERS
+
+	2.1. KEYS
+
+	A pair of sequences is stored only once, under its canonical form
+(min(i, j), max(i, j)). The two indices (31 bits each) are packed into a
+64-bit key, and the result is kept in bit 62 of the same word, so an entry
+takes 8 bytes. Bit 63 is the reference bit of the entry (see 2.3). A word of 0
+marks an empty slot (there is no valid key 0, as the two indices of a pair are
+different).
+
+	2.2. SHARDS
+
+	The table is split into CACHESHARDS shards, selected by the high bits of
+the hash of the key, each with its own mutex. Each shard is an open-addressing
+table with linear probing. When a shard reaches its maximum load, its size is
+doubled and its entries rehashed. Since threads working on different pairs
+almost always use different shards, they rarely wait for each other.
+
+	2.3. MEMORY BUDGET
+
+	By default the table grows as long as entries are added. With a memory
+budget, a shard that has reached its share of the budget evicts an entry to
+make room for a new one instead of growing, with the clock algorithm: every
+lookup that finds an entry sets its reference bit, and the hand of the shard
+sweeps its slots, clearing the reference bits it passes, until it finds an
+entry whose bit is already clear. That entry has not been looked up since the
+hand last passed it, and is removed (the entries after it in the same run of
+slots are shifted back, so that the linear probing needs no tombstones).
+
+	Only the entries of the pairs that are not significant are evicted: a
+missing pair is not an edge either (see edge()), so the answers of edge() never
+change, and the only cost of an eviction is a new alignment if the pair is
+needed again. The significant pairs are few, but a shard holding nothing else
+grows beyond the budget rather than losing them.
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR
+
+	The constructor takes the maximum load of the shards (which is limited
+to CACHEMAXLOAD, as the probes get long in a full open-addressing table). It
+can be changed later with load(), which only affects the growth of the
+table from then on. The table starts small, and without a memory budget.
+
+	3.2. OTHER FUNCTIONS
+
+		- find(): returns CACHEYES or CACHENO if the result of a pair is
+	stored, and CACHEMISS otherwise.
+		- known(), edge(): whether the result of a pair is stored, and
+	whether the pair is significant (false if the result is not stored).
+		- insert(): stores the result of a pair (replacing any previous
+	result), evicting another one if the budget is reached (see 2.3).
+		- reserve(): sizes the table for an expected number of entries,
+	to avoid rehashing while it fills up (within the budget).
+		- budget(): sets the memory budget of the table, in bytes (0 for
+	none), or returns it. A smaller budget only takes effect as the shards
+	fill up: they are never shrunk.
+		- size(), capacity(): the number of entries, and the number of
+	slots.
+		- bytes(): the memory used by the slots.
+		- evicted(): the number of entries evicted so far.
+		- hash(): the hash of a 64-bit word (see cache.cpp), also used
+	by class diskcache (see diskcache.h).
+
+4. NOTES
+
+	All the functions can be called concurrently from several threads.
+
+	*/
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <vector>
+#include <pthread.h>
+
+const int CACHESHARDBITS = 6;	// the number of shards is 2^CACHESHARDBITS
+const int CACHESHARDS = 1 << CACHESHARDBITS;
+const int CACHESLOTS = 16;	// the initial number of slots of a shard
+const double CACHELOAD = 0.5;	// default maximum load of the shards
+const double CACHEMAXLOAD = 0.9;	// largest maximum load allowed
+const double CACHENOBUDGET = 0;	// the budget of a table without one
+
+// the results of find()
+const int CACHEMISS = -1;
+const int CACHENO = 0;
+const int CACHEYES = 1;
+
+typedef unsigned long long cacheword;
+
+class cache
+{
+	public:
+		// constructor and destructor
+		cache( double load = CACHELOAD );
+		~cache();
+
+		// "get" functions
+		int find( int, int ) const;
+		bool known( int i, int j ) const
+			{ return find( i, j ) != CACHEMISS; }
+		bool edge( int i, int j ) const
+			{ return find( i, j ) == CACHEYES; }
+		double size( void ) const;
+		double capacity( void ) const;
+		double bytes( void ) const
+			{ return capacity() * sizeof( cacheword ); }
+		double load( void ) const { return load_; }
+		double budget( void ) const { return budget_; }
+		double evicted( void ) const;
+		static cacheword hash( cacheword );
+
+		// "set" functions
+		void insert( int, int, bool );
+		void reserve( double );
+		void load( double );
+		void budget( double );
+
+	private:
+		// one shard of the table
+		struct shard
+		{
+			mutable pthread_mutex_t lock_;
+			mutable vector<cacheword> slots_;	// (the
+						// reference bits are set by
+						// lookups)
+			int count_;		// the number of entries
+			int hand_;		// the hand of the clock
+			double evicted_;	// the entries evicted
+		};
+
+		// the key of a pair
+		static cacheword key( int, int );
+
+		// find the slot of a key in a shard (its own, or the empty slot
+		// where it would go)
+		static int probe( const shard&, cacheword, cacheword );
+
+		// double the size of a shard
+		void grow( shard& );
+
+		// may a shard double its size within the budget?
+		bool growable( const shard& ) const;
+
+		// evict an entry of a shard (see 2.3), and remove the entry of
+		// a slot
+		bool evict( shard& );
+		static void remove( shard&, int );
+
+		// no copying
+		cache( const cache& );
+		cache& operator=( const cache& );
+
+		shard shards_[CACHESHARDS];	// the shards
+		double load_;		// the maximum load of the shards
+		double budget_;		// the memory budget, in bytes
+};
+
+#endif
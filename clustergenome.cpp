@@ -0,0 +1,266 @@
+	/*
+File:		clustergenome.cpp
+Title:		Class definitions for class "clustergenome" (declared in
+		clustergenome.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <vector>
+#include <ga/ga.h>
+#include "clustergenome.h"
+
+/******************************************************************************/
+
+// constructor for class clustergenome
+
+clustergenome::clustergenome( int n, GAGenome::Evaluator f, clusteredge e )
+	:
+	GA1DArrayGenome<int>( n, f ),
+	edge_( e ),
+	root_( n ),
+	next_( n ),
+	size_( n ),
+	score_( 0 ),
+	valid_( false )
+{
+	GAGenome::crossover( onepoint );
+}
+
+/******************************************************************************/
+
+// copy constructor for class clustergenome
+
+clustergenome::clustergenome( const clustergenome& c )
+	:
+	GA1DArrayGenome<int>( c ),
+	edge_( c.edge_ ),
+	root_( c.root_ ),
+	next_( c.next_ ),
+	size_( c.size_ ),
+	score_( c.score_ ),
+	valid_( c.valid_ ),
+	changes_( c.changes_ )
+{
+}
+
+/******************************************************************************/
+
+// a copy of the genome, used by GAlib to fill the populations
+
+GAGenome* clustergenome::clone( GAGenome::CloneMethod ) const
+{
+	return new clustergenome( *this );
+}
+
+/******************************************************************************/
+
+// copy a genome into this one. The clusters are copied if it is a
+//	clustergenome too, and invalidated otherwise.
+
+void clustergenome::copy( const GAGenome& g )
+{
+	if( &g == this )
+	{
+		return;
+	}
+	GA1DArrayGenome<int>::copy( g );
+
+	const clustergenome* c = dynamic_cast<const clustergenome*>( &g );
+	if( c == 0 )
+	{
+		invalidate();
+		return;
+	}
+	edge_ = c->edge_;
+	root_ = c->root_;
+	next_ = c->next_;
+	size_ = c->size_;
+	score_ = c->score_;
+	valid_ = c->valid_;
+	changes_ = c->changes_;
+}
+
+/******************************************************************************/
+
+// the one-point crossover of GA1DArrayGenome (the default of GAlib), after
+//	which the clusters of the children must be rebuilt
+
+int clustergenome::onepoint( const GAGenome& a, const GAGenome& b,
+	GAGenome* c, GAGenome* d )
+{
+	int n = GA1DArrayGenome<int>::OnePointCrossover( a, b, c, d );
+	if( c )
+	{
+		static_cast<clustergenome*>( c )->invalidate();
+	}
+	if( d )
+	{
+		static_cast<clustergenome*>( d )->invalidate();
+	}
+	return n;
+}
+
+/******************************************************************************/
+
+// set gene i to j, recording the change for the next evaluation
+
+void clustergenome::change( int i, int j )
+{
+	gene( i, j );
+	if( valid_ )
+	{
+		changes_.push_back( i );
+	}
+}
+
+/******************************************************************************/
+
+// bring the clusters up to date, and return their score
+
+float clustergenome::fitness( void )
+{
+	int n = length();
+
+	if( !valid_ || static_cast<int>( changes_.size() ) > n / CLUSTERREBUILD )
+	{
+		rebuild();
+		return static_cast<float>( score_ );
+	}
+	if( changes_.empty() )
+	{
+		return static_cast<float>( score_ );
+	}
+
+	// list the members of the old clusters of the changed sequences and of
+	// their new partners, once each (a listed cluster has its size
+	// negated), and take their scores off
+	members_.clear();
+	for( int c = 0; c < static_cast<int>( changes_.size() ); c++ )
+	{
+		int ends[2] = { changes_[c], gene( changes_[c] ) };
+		for( int e = 0; e < 2; e++ )
+		{
+			int r = root_[ ends[e] ];
+			if( size_[r] < 0 )
+			{
+				continue;
+			}
+			score_ -= static_cast<double>( size_[r] - 1 )
+				* ( size_[r] - 1 );
+			size_[r] = -size_[r];
+			int v = r;
+			do
+			{
+				members_.push_back( v );
+				v = next_[v];
+			} while( v != r );
+		}
+	}
+	changes_.clear();
+
+	recompute( members_ );
+	return static_cast<float>( score_ );
+}
+
+/******************************************************************************/
+
+// rebuild all the clusters
+
+void clustergenome::rebuild( void )
+{
+	int n = length();
+
+	members_.resize( n );
+	for( int i = 0; i < n; i++ )
+	{
+		members_[i] = i;
+	}
+	score_ = 0;
+	recompute( members_ );
+	valid_ = true;
+	changes_.clear();
+}
+
+/******************************************************************************/
+
+// the root of the cluster of sequence i during recompute(), with path halving
+
+int clustergenome::find( int i )
+{
+	while( root_[i] != i )
+	{
+		root_[i] = root_[ root_[i] ];
+		i = root_[i];
+	}
+	return i;
+}
+
+/******************************************************************************/
+
+// recompute the clusters of a set of sequences (whose old clusters have been
+//	taken off the score), given that the partners of all its members are in
+//	it. Their root entries are used as the parents of a union-find.
+
+void clustergenome::recompute( const vector<int>& s )
+{
+	int k;
+
+	for( k = 0; k < static_cast<int>( s.size() ); k++ )
+	{
+		root_[ s[k] ] = s[k];
+	}
+
+	// join each sequence to its partner if their alignment is significant
+	for( k = 0; k < static_cast<int>( s.size() ); k++ )
+	{
+		int i = s[k], j = gene(i);
+		if( !edge_( i, j ) )
+		{
+			continue;
+		}
+		int a = find( i ), b = find( j );
+		if( a != b )
+		{
+			root_[a] = b;
+		}
+	}
+
+	// point every sequence at its root, and start the lists of members at
+	// the roots
+	for( k = 0; k < static_cast<int>( s.size() ); k++ )
+	{
+		root_[ s[k] ] = find( s[k] );
+	}
+	for( k = 0; k < static_cast<int>( s.size() ); k++ )
+	{
+		int i = s[k];
+		if( root_[i] == i )
+		{
+			next_[i] = i;
+			size_[i] = 0;
+		}
+	}
+
+	// then add the other members after their roots, and count them
+	for( k = 0; k < static_cast<int>( s.size() ); k++ )
+	{
+		int i = s[k], r = root_[i];
+		size_[r]++;
+		if( i != r )
+		{
+			next_[i] = next_[r];
+			next_[r] = i;
+		}
+	}
+
+	for( k = 0; k < static_cast<int>( s.size() ); k++ )
+	{
+		int i = s[k];
+		if( root_[i] == i )
+		{
+			score_ += static_cast<double>( size_[i] - 1 )
+				* ( size_[i] - 1 );
+		}
+	}
+}
@@ -0,0 +1,133 @@
+	/*
+File:		clustergenome.h
+Title:		Class declaration for class "clustergenome", the genome of gaest
+		with an incrementally evaluated objective.
+
+Description:
+
+1. OVERVIEW
+
+	The genome of gaest (see gaest.cpp) is an array of n genes, gene i
+holding the partner of sequence i. Its score is the sum, over the clusters of
+the graph joining each sequence to its partner when their alignment is
+significant, of the square of the cluster size minus one. Building that graph
+and traversing it costs O(n) for every evaluation, although the mutator only
+changes about pMut * n genes of a genome between two evaluations.
+
+	The clustergenome class is a GA1DArrayGenome<int> (see GAlib) that keeps
+its clusters along with its genes. The genes changed since the last evaluation
+are recorded, and fitness() only recomputes the clusters they belong to: the
+cost of an evaluation after a mutation is proportional to the size of the
+clusters touched, not to n.
+
+2. DATA MEMBERS
+
+	2.1. CLUSTERS
+
+	Every sequence has the root of its cluster (one of its members), and the
+next member of the cluster in a circular list, so that the members of a
+cluster can be listed from any of them. The size of each cluster is kept at
+its root, along with the current score.
+
+	2.2. CHANGES
+
+	The changes are the genes set by change() since the last evaluation. If
+the clusters are not valid (a new or crossed-over genome), or if more than
+n / CLUSTERREBUILD genes have changed, all of them are rebuilt instead.
+
+	2.3. EDGES
+
+	Whether two sequences are joined is given by an edge function, of type
+clusteredge, which must always give the same answer for the same pair (in
+gaest, the pairs of all the genes have been aligned before the genome is
+evaluated).
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTORS
+
+	The constructor takes the number of genes, the GAlib objective, and the
+edge function. The copy constructor, copy() and clone() copy the clusters and
+the changes along with the genes, so the children copied from their parents
+by the GA keep them.
+
+	3.2. OTHER FUNCTIONS
+
+		- mate(): the next member of the cluster of a sequence, as of the
+	last evaluation (the sequence itself if it is alone in its cluster, or
+	if the clusters are not valid).
+		- change(): sets a gene, recording it for the next evaluation.
+	The initializer and the mutator must use it instead of gene().
+		- fitness(): updates the clusters, and returns the score.
+		- invalidate(): marks the clusters as invalid, to be rebuilt by
+	fitness(). For genes set by other means than change().
+		- onepoint(): the one-point crossover of GA1DArrayGenome, which
+	invalidates the clusters of the children.
+
+4. NOTES
+
+	The clusters of the affected genes are recomputed together: the union of
+the old clusters of the changed sequences and of their new partners holds the
+new partners of all its members, so its new clusters are found by a union-find
+over its members only, using the root array as the parent array.
+
+	*/
+
+#ifndef CLUSTERGENOME_H
+#define CLUSTERGENOME_H
+
+#include <vector>
+#include <ga/ga.h>
+
+const int CLUSTERREBUILD = 4;	// rebuild if more than n / this genes change
+
+typedef bool (*clusteredge)( int, int );
+
+class clustergenome : public GA1DArrayGenome<int>
+{
+	public:
+		// constructors, assignment operator
+		clustergenome( int, GAGenome::Evaluator, clusteredge );
+		clustergenome( const clustergenome& );
+		clustergenome& operator=( const GAGenome& g )
+			{ copy( g ); return *this; }
+		virtual ~clustergenome() { ; }
+		virtual GAGenome* clone( GAGenome::CloneMethod flag
+			= GAGenome::CONTENTS ) const;
+		virtual void copy( const GAGenome& );
+
+		// "get" functions
+		int mate( int i ) const { return valid_ ? next_[i] : i; }
+
+		// other functions
+		void change( int i, int j );
+		float fitness( void );
+		void invalidate( void ) { valid_ = false; changes_.clear(); }
+		static int onepoint( const GAGenome&, const GAGenome&,
+			GAGenome*, GAGenome* );
+
+	private:
+		// the root of the cluster of a sequence, while the clusters of
+		// a set of sequences are recomputed
+		int find( int );
+
+		// recompute the clusters of a set of sequences, closed under
+		// the partners of its members
+		void recompute( const vector<int>& );
+
+		// rebuild all the clusters
+		void rebuild( void );
+
+		clusteredge edge_;	// are two sequences joined?
+
+		vector<int> root_;	// the root of the cluster of each sequence
+		vector<int> next_;	// the next member of its cluster
+		vector<int> size_;	// the size of each cluster (at its root)
+		double score_;		// the score of the clusters
+		bool valid_;		// are the clusters up to date?
+
+		vector<int> changes_;	// the genes changed since
+		vector<int> members_;	// the sequences being recomputed
+};
+
+#endif
@@ -0,0 +1,99 @@
+	/*
+File:		clusters.cpp
+Title:		Class definitions for class "clusters" (declared in clusters.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <vector>
+#include <utility>
+#include "clusters.h"
+
+/******************************************************************************/
+
+// build the graph of n nodes from a list of edges. Each edge (i, j) adds j to
+//	the neighbours of i and i to those of j, in the order of the list.
+
+void clusters::build( int n, const vector< pair<int, int> >& edges )
+{
+	int e;
+
+	// count the neighbours of each node, and turn the counts into offsets
+	offsets_.assign( n + 1, 0 );
+	for( e = 0; e < static_cast<int>( edges.size() ); e++ )
+	{
+		offsets_[ edges[e].first + 1 ]++;
+		offsets_[ edges[e].second + 1 ]++;
+	}
+	for( int i = 0; i < n; i++ )
+	{
+		offsets_[i+1] += offsets_[i];
+	}
+
+	// then fill them in, using next_ as the fill position of each node
+	neighbours_.resize( offsets_[n] );
+	next_.assign( offsets_.begin(), offsets_.end() - 1 );
+	for( e = 0; e < static_cast<int>( edges.size() ); e++ )
+	{
+		int i = edges[e].first, j = edges[e].second;
+		neighbours_[ next_[i]++ ] = j;
+		neighbours_[ next_[j]++ ] = i;
+	}
+
+	visited_.assign( n, 0 );
+	stack_.reserve( n );
+	members_.clear();
+}
+
+/******************************************************************************/
+
+// clear the marks of the visited nodes
+
+void clusters::reset( void )
+{
+	visited_.assign( visited_.size(), 0 );
+	members_.clear();
+}
+
+/******************************************************************************/
+
+// traverse the cluster of node i depth-first (unless it has been visited),
+//	leaving its members in the order of their visit. Returns the size of
+//	the cluster, or 0.
+
+int clusters::traverse( int i )
+{
+	members_.clear();
+	if( visited_[i] )
+	{
+		return 0;
+	}
+
+	// next_ holds the position of the next neighbour to try of every
+	// node on the stack
+	visited_[i] = 1;
+	members_.push_back( i );
+	next_[i] = offsets_[i];
+	stack_.clear();
+	stack_.push_back( i );
+
+	while( !stack_.empty() )
+	{
+		int v = stack_.back();
+		if( next_[v] == offsets_[v+1] )
+		{
+			stack_.pop_back();
+			continue;
+		}
+
+		int w = neighbours_[ next_[v]++ ];
+		if( !visited_[w] )
+		{
+			visited_[w] = 1;
+			members_.push_back( w );
+			next_[w] = offsets_[w];
+			stack_.push_back( w );
+		}
+	}
+	return static_cast<int>( members_.size() );
+}
@@ -0,0 +1,92 @@
+	/*
+File:		clusters.h
+Title:		Class declaration for class "clusters", the connected
+		components of a graph of sequences.
+
+Description:
+
+1. OVERVIEW
+
+	gaest and exest print the clusters of a graph whose nodes are the
+sequences and whose edges are the significant pairs. Both used to build the
+graph as a vector of linked lists (one node allocated per edge) and to
+traverse it recursively, which on long, chain-like clusters recursed about as
+deep as there are sequences. The clusters class stores the graph in a single
+array and traverses it iteratively, with buffers that are reused from one
+traversal to the next.
+
+2. DATA MEMBERS
+
+	2.1. GRAPH
+
+	The graph is stored in compressed sparse row (CSR) form: the neighbours
+of every node, one node after the other, and the offset of the neighbours of
+each node. An edge (i, j) appears in the neighbours of both i and j. The
+neighbours of a node are in the order given to build(), so a traversal
+visits the nodes in the same order as a recursive one over adjacency lists
+filled in that order.
+
+	2.2. TRAVERSAL
+
+	A depth-first traversal keeps an explicit stack of nodes, and for each
+node the position of the next neighbour to visit. The nodes visited are
+marked, so that each cluster is traversed once, and the members of the last
+cluster traversed are kept in the order of their visit.
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR
+
+	The constructor creates an empty graph.
+
+	3.2. OTHER FUNCTIONS
+
+		- build(): builds the graph of n nodes from a list of edges, and
+	clears the marks.
+		- traverse(): traverses the cluster of a node, if it has not been
+	visited yet, and returns its size (0 if it had been visited).
+		- members(): the members of the last cluster traversed, in the
+	order of their visit.
+		- visited(): whether a node has been visited.
+		- degree(): the number of neighbours of a node.
+		- reset(): clears the marks, to traverse the graph again.
+		- size(): the number of nodes.
+
+	*/
+
+#ifndef CLUSTERS_H
+#define CLUSTERS_H
+
+#include <vector>
+#include <utility>
+
+class clusters
+{
+	public:
+		// constructor
+		clusters( void ) { ; }
+
+		// "get" functions
+		int size( void ) const
+			{ return static_cast<int>( visited_.size() ); }
+		int degree( int i ) const
+			{ return offsets_[i+1] - offsets_[i]; }
+		bool visited( int i ) const { return visited_[i] != 0; }
+		const vector<int>& members( void ) const { return members_; }
+
+		// other functions
+		void build( int, const vector< pair<int, int> >& );
+		int traverse( int );
+		void reset( void );
+
+	private:
+		vector<int> offsets_;	// where the neighbours of each node start
+		vector<int> neighbours_;	// the neighbours of all the nodes
+
+		vector<char> visited_;	// the marks of the visited nodes
+		vector<int> stack_;	// the nodes being traversed
+		vector<int> next_;	// the next neighbour of each to visit
+		vector<int> members_;	// the last cluster traversed
+};
+
+#endif
@@ -0,0 +1,213 @@
+	/*
+File:		clusterstate.cpp
+Title:		Class definitions for class "clusterstate" (declared in
+		clusterstate.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include "cache.h"
+#include "dna.h"
+#include "dynamic.h"
+#include "seqstore.h"
+#include "diskcache.h"
+#include "clusterstate.h"
+
+const int STATEHEADER = 8;		// the size of STATEMAGIC in the file
+
+/******************************************************************************/
+
+// read and write a binary value
+
+template <class T>
+static inline bool get( istream& in, T& v )
+{
+	in.read( reinterpret_cast<char*>( &v ), sizeof( v ) );
+	return in.good();
+}
+
+template <class T>
+static inline void put( ostream& out, const T& v )
+{
+	out.write( reinterpret_cast<const char*>( &v ), sizeof( v ) );
+}
+
+// the number of bytes left to read in a file of a given size, which bounds
+//	the counts read from it
+
+static inline cacheword remaining( istream& in, streampos end )
+{
+	streampos here = in.tellg();
+	return ( in.good() && end > here ) ?
+		static_cast<cacheword>( end - here ) : 0;
+}
+
+/******************************************************************************/
+
+// constructor for class clusterstate
+
+clusterstate::clusterstate( void )
+	:
+	size_( 0 )
+{
+}
+
+/******************************************************************************/
+
+// the signature of the parameters the edges are found with: those of the
+//	alignments (see diskcache.h), the length of the k-mers (0 without a
+//	prefilter), and whether the k-mer index gives the pairs
+
+cacheword clusterstate::signature( const dynamic& d, int bw, int k,
+	bool indexed )
+{
+	cacheword sg = diskcache::signature( d, bw, k );
+	return cache::hash( sg ^ ( static_cast<cacheword>( k ) << 1 )
+		^ ( indexed ? 1 : 0 ) );
+}
+
+/******************************************************************************/
+
+// add the sequences of a state file to a store, and read its edges. A missing
+//	file is an empty state. A file whose counts do not fit in its size, or
+//	whose nucleotide codes or edges are not valid, is rejected.
+
+bool clusterstate::load( const string& file, cacheword sg, seqstore& store )
+{
+	size_ = 0;
+	edges_.clear();
+
+	ifstream in( file.c_str(), ios::in | ios::binary );
+	if( !in.is_open() )
+	{
+		return true;
+	}
+
+	in.seekg( 0, ios::end );
+	streampos end = in.tellg();
+	in.seekg( 0, ios::beg );
+
+	char magic[STATEHEADER];
+	cacheword signature, sequences, edges;
+	in.read( magic, STATEHEADER );
+	if( !in.good() || memcmp( magic, STATEMAGIC, STATEHEADER ) != 0
+		|| !get( in, signature ) || signature != sg
+		|| !get( in, sequences ) || !get( in, edges )
+		|| sequences > static_cast<cacheword>( INT_MAX )
+		|| sequences > remaining( in, end ) / ( 2 * sizeof( int ) ) )
+	{
+		return false;
+	}
+
+	string name;
+	vector<unsigned char> codes;
+	for( cacheword s = 0; s < sequences; s++ )
+	{
+		int namelen, length;
+		if( !get( in, namelen ) || !get( in, length )
+			|| namelen < 0 || length < 0
+			|| static_cast<cacheword>( namelen ) + length
+			> remaining( in, end ) )
+		{
+			return false;
+		}
+		name.resize( namelen );
+		codes.resize( length + 1 );
+		if( namelen > 0 )
+		{
+			in.read( &name[0], namelen );
+		}
+		in.read( reinterpret_cast<char*>( &codes[0] ), length );
+		if( !in.good() )
+		{
+			return false;
+		}
+
+		// the codes are those of the alphabet (X is never stored)
+		for( int p = 0; p < length; p++ )
+		{
+			if( codes[p] == X || codes[p] > DNAALPHA )
+			{
+				return false;
+			}
+		}
+		store.add( name, &codes[0], length );
+	}
+
+	if( edges > remaining( in, end ) / ( 2 * sizeof( int ) ) )
+	{
+		return false;
+	}
+	int n = static_cast<int>( sequences );
+	edges_.resize( edges );
+	for( cacheword e = 0; e < edges; e++ )
+	{
+		if( !get( in, edges_[e].first ) || !get( in, edges_[e].second )
+			|| edges_[e].first < 0 || edges_[e].first >= n
+			|| edges_[e].second < 0 || edges_[e].second >= n )
+		{
+			edges_.clear();
+			return false;
+		}
+	}
+
+	size_ = static_cast<int>( sequences );
+	return true;
+}
+
+/******************************************************************************/
+
+// write the sequences and the edges to a state file, under a temporary name
+//	first
+
+bool clusterstate::save( const string& file, cacheword sg,
+	const vector<dna>& sequences, const vector< pair<int, int> >& edges )
+	const
+{
+	string temporary( file + ".tmp" );
+	ofstream out( temporary.c_str(),
+		ios::out | ios::binary | ios::trunc );
+	if( !out.is_open() )
+	{
+		return false;
+	}
+
+	out.write( STATEMAGIC, STATEHEADER );
+	put( out, sg );
+	put( out, static_cast<cacheword>( sequences.size() ) );
+	put( out, static_cast<cacheword>( edges.size() ) );
+
+	vector<unsigned char> codes;
+	for( int s = 0; s < static_cast<int>( sequences.size() ); s++ )
+	{
+		string name( sequences[s].name() );
+		int namelen = static_cast<int>( name.size() );
+		int length = sequences[s].length();
+		put( out, namelen );
+		put( out, length );
+		out.write( name.data(), namelen );
+		codes.resize( length + 1 );
+		sequences[s].unpack( &codes[0] );
+		out.write( reinterpret_cast<const char*>( &codes[0] ), length );
+	}
+	for( int e = 0; e < static_cast<int>( edges.size() ); e++ )
+	{
+		put( out, edges[e].first );
+		put( out, edges[e].second );
+	}
+
+	out.close();
+	if( out.fail() || rename( temporary.c_str(), file.c_str() ) != 0 )
+	{
+		remove( temporary.c_str() );
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,108 @@
+	/*
+File:		clusterstate.h
+Title:		Class declaration for class "clusterstate", the clustering of
+		the sequences seen so far, kept between runs of exest.
+
+Description:
+
+1. OVERVIEW
+
+	ESTs often arrive in batches, and clustering every batch together with
+all the previous ones from scratch aligns the same pairs again and again. The
+clusterstate class keeps, in a file, the sequences clustered so far and the
+significant pairs among them. A run of exest in streaming mode (-state) loads
+them, appends the new sequences after them, aligns only the pairs involving
+a new sequence (see allpairs.h), and saves the whole graph for the next batch.
+The clusters printed are those of all the sequences: the old ones keep their
+indices, and the new ones are numbered after them.
+
+2. DATA MEMBERS
+
+	2.1. FILE
+
+	The file starts with the 8 characters STATEMAGIC, followed by the
+signature of the parameters, the numbers of sequences and of edges, the
+sequences (the length of the name and of the sequence, the name, and one
+nucleotide code per byte), and the edges (pairs of 32-bit indices, sorted).
+All numbers are in the byte order of the machine that wrote them. The file is
+written under a temporary name and then renamed, so a run that fails leaves
+the previous state in place.
+
+	2.2. SIGNATURE
+
+	The edges saved are only valid for the parameters they were found with:
+the alignment parameters and band (see diskcache.h), the length of the k-mers
+of the prefilter and the use of the k-mer index. A file with another
+signature is refused, rather than mixing clusters found with different
+parameters.
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR
+
+	The constructor creates an empty state.
+
+	3.2. OTHER FUNCTIONS
+
+		- load(): adds the sequences of a state file to a seqstore, and
+	reads its edges. A missing file is an empty state (the first batch).
+	Returns false if the file can not be read, is not a state file, has
+	another signature, or is corrupt: counts larger than the rest of the
+	file, nucleotide codes outside the alphabet (see dna.h), or edges with
+	an end that is not one of its sequences.
+		- save(): writes the sequences and the edges to a state file.
+	Returns false if it can not be written.
+		- signature(): the signature of a set of parameters.
+		- size(): the number of sequences loaded.
+		- edges(): the edges loaded.
+
+4. NOTES
+
+	The new sequences are aligned against all the old ones, not only against
+a representative of each cluster, so without a k-mer index the clusters are
+exactly those of a single run over all the batches. With -index, the
+candidates of a sequence depend on all the others (see kmerindex.h), and the
+pairs of old sequences are not looked at again, so the clusters may differ
+slightly from those of a single run.
+
+	The k-mer profiles are rebuilt from the sequences on every run; they take
+much less time to build than the alignments they save.
+
+	*/
+
+#ifndef CLUSTERSTATE_H
+#define CLUSTERSTATE_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include "cache.h"
+#include "dna.h"
+#include "dynamic.h"
+#include "seqstore.h"
+
+const char STATEMAGIC[] = "GAESTST1";	// the first 8 bytes of a state file
+
+class clusterstate
+{
+	public:
+		// constructor
+		clusterstate( void );
+
+		// "get" functions
+		int size( void ) const { return size_; }
+		const vector< pair<int, int> >& edges( void ) const
+			{ return edges_; }
+		static cacheword signature( const dynamic&, int, int, bool );
+
+		// other functions
+		bool load( const string&, cacheword, seqstore& );
+		bool save( const string&, cacheword, const vector<dna>&,
+			const vector< pair<int, int> >& ) const;
+
+	private:
+		int size_;		// the number of sequences loaded
+		vector< pair<int, int> > edges_;	// the edges loaded
+};
+
+#endif
@@ -0,0 +1,408 @@
+	/*
+File:		device.cu
+Title:		Class definitions for class "device" (declared in device.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+		Compiled by nvcc with CUDA (make CUDA=1), and otherwise by the
+		C++ compiler, in which case there is never a device.
+	*/
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include "dna.h"
+#include "dynamic.h"
+#include "device.h"
+
+#ifdef __CUDACC__
+
+#include <cuda_runtime.h>
+
+/******************************************************************************/
+
+// the code of nucleotide i of a sequence starting at offset in the arena
+
+__device__ static inline int code( const unsigned char* arena,
+	unsigned long long offset, int i )
+{
+	unsigned long long p = offset + i;
+	return ( arena[p >> 1] >> ( ( p & 1 ) << 2 ) ) & 0xf;
+}
+
+/******************************************************************************/
+
+// align the pairs of a launch, one per block, and keep the significant ones
+//	(see device.h, 2.3). The cells of anti-diagonal d are (i, d-i), and
+//	every array of the shared memory is indexed by i. H, E and F are
+//	saturated at 0 like those of the vectorized kernel (see striped.h), so
+//	row and column 0 are 0, and so are the entries of the arrays that hold
+//	them (never written, since the cells (i, d-i) computed have i < d).
+//	Reaching the threshold on diagonal d is flagged in found[d & 1], which
+//	all the threads read after the barrier ending d, and which is not
+//	written again before the barrier ending d+1.
+
+__global__ static void alignpairs( const unsigned char* arena,
+	const unsigned long long* offsets, const int* lengths,
+	const int* subst, int go, int gx, int stop, const int* pairs,
+	int npairs, int* edges, int* count )
+{
+	extern __shared__ int shared[];
+
+	int p = blockIdx.x;
+	if( p >= npairs )
+	{
+		return;
+	}
+	int x = pairs[2*p], y = pairs[2*p+1];
+	int xlen = lengths[x], ylen = lengths[y];
+	int stride = xlen + 1;
+
+	int* h[3] = { shared, shared + stride, shared + 2*stride };
+	int* e[2] = { shared + 3*stride, shared + 4*stride };
+	int* f[2] = { shared + 5*stride, shared + 6*stride };
+	unsigned char* xs = reinterpret_cast<unsigned char*>
+		( shared + 7*stride );
+	__shared__ int found[2];
+
+	int i;
+	for( i = threadIdx.x; i < 7*stride; i += blockDim.x )
+	{
+		shared[i] = 0;
+	}
+	for( i = threadIdx.x; i < xlen; i += blockDim.x )
+	{
+		xs[i] = static_cast<unsigned char>( code( arena, offsets[x], i ) );
+	}
+	if( threadIdx.x == 0 )
+	{
+		found[0] = found[1] = 0;
+	}
+	__syncthreads();
+
+	for( int d = 2; d <= xlen + ylen && !found[(d+1) & 1]; d++ )
+	{
+		// the arrays of diagonals d, d-1 and d-2
+		int* hc = h[d % 3];
+		int* hp = h[(d+2) % 3];
+		int* hq = h[(d+1) % 3];
+		int* ec = e[d & 1];
+		int* ep = e[(d+1) & 1];
+		int* fc = f[d & 1];
+		int* fp = f[(d+1) & 1];
+
+		int lo = ( d - ylen > 1 ) ? d - ylen : 1;
+		int hi = ( d - 1 < xlen ) ? d - 1 : xlen;
+		for( i = lo + threadIdx.x; i <= hi; i += blockDim.x )
+		{
+			int j = d - i;
+			int ev = max( max( ep[i-1] - gx, hp[i-1] - go ), 0 );
+			int fv = max( max( fp[i] - gx, hp[i] - go ), 0 );
+			int hv = hq[i-1] + subst[ xs[i-1] * DNACODES
+				+ code( arena, offsets[y], j-1 ) ];
+			hv = max( max( hv, 0 ), max( ev, fv ) );
+			hc[i] = hv;
+			ec[i] = ev;
+			fc[i] = fv;
+			if( hv >= stop )
+			{
+				found[d & 1] = 1;
+			}
+		}
+		__syncthreads();
+	}
+
+	if( threadIdx.x == 0 && ( found[0] || found[1] ) )
+	{
+		int k = atomicAdd( count, 1 );
+		edges[2*k] = x;
+		edges[2*k+1] = y;
+	}
+}
+
+/******************************************************************************/
+
+// constructor for class device
+
+device::device( void )
+	:
+	available_( false ),
+	name_( "none" ),
+	go_( 0 ), gx_( 0 ), stop_( 0 ),
+	arena_( 0 ), offsets_( 0 ), dlengths_( 0 ), dsubst_( 0 ), pairs_( 0 ),
+	edges_( 0 ), count_( 0 )
+{
+}
+
+/******************************************************************************/
+
+// use the first device, if any, and allocate the buffers of a launch
+
+bool device::open( void )
+{
+	if( available_ )
+	{
+		return true;
+	}
+
+	int devices = 0;
+	if( cudaGetDeviceCount( &devices ) != cudaSuccess || devices < 1
+		|| cudaSetDevice( 0 ) != cudaSuccess )
+	{
+		return false;
+	}
+
+	cudaDeviceProp properties;
+	if( cudaGetDeviceProperties( &properties, 0 ) == cudaSuccess )
+	{
+		name_ = properties.name;
+	}
+
+	if( cudaMalloc( &dsubst_, DNACODES * DNACODES * sizeof( int ) )
+			!= cudaSuccess
+		|| cudaMalloc( &pairs_, 2 * DEVICEPAIRS * sizeof( int ) )
+			!= cudaSuccess
+		|| cudaMalloc( &edges_, 2 * DEVICEPAIRS * sizeof( int ) )
+			!= cudaSuccess
+		|| cudaMalloc( &count_, sizeof( int ) ) != cudaSuccess )
+	{
+		release();
+		name_ = "none";
+		return false;
+	}
+	available_ = true;
+	return true;
+}
+
+/******************************************************************************/
+
+// destructor for class device
+
+device::~device()
+{
+	release();
+}
+
+/******************************************************************************/
+
+// free the buffers of the device
+
+void device::release( void )
+{
+	void** buffers[] = { &arena_, &offsets_, &dlengths_, &dsubst_, &pairs_,
+		&edges_, &count_ };
+	for( int b = 0; b < 7; b++ )
+	{
+		if( *buffers[b] )
+		{
+			cudaFree( *buffers[b] );
+			*buffers[b] = 0;
+		}
+	}
+}
+
+/******************************************************************************/
+
+// take the integer scores of a dynamic object
+
+bool device::scoring( const dynamic& d )
+{
+	if( !available_ || !d.integral( subst_, go_, gx_, stop_ ) )
+	{
+		return false;
+	}
+	return cudaMemcpy( dsubst_, subst_, sizeof( subst_ ),
+		cudaMemcpyHostToDevice ) == cudaSuccess;
+}
+
+/******************************************************************************/
+
+// copy the sequences to the device, packed two nucleotides per byte
+
+bool device::upload( const vector<dna>& sequences )
+{
+	if( !available_ )
+	{
+		return false;
+	}
+
+	int n = static_cast<int>( sequences.size() );
+	vector<unsigned long long> offsets( n > 0 ? n : 1 );
+	lengths_.resize( n > 0 ? n : 1 );
+	unsigned long long total = 0;
+	int s;
+	for( s = 0; s < n; s++ )
+	{
+		offsets[s] = total;
+		lengths_[s] = sequences[s].length();
+		total += lengths_[s];
+	}
+
+	vector<unsigned char> arena( ( total + 1 ) / 2 + 1, 0 );
+	vector<unsigned char> codes;
+	for( s = 0; s < n; s++ )
+	{
+		codes.resize( lengths_[s] + 1 );
+		sequences[s].unpack( &codes[0] );
+		for( int i = 0; i < lengths_[s]; i++ )
+		{
+			unsigned long long p = offsets[s] + i;
+			arena[p >> 1] |= codes[i] << ( ( p & 1 ) << 2 );
+		}
+	}
+
+	void** buffers[] = { &arena_, &offsets_, &dlengths_ };
+	for( int b = 0; b < 3; b++ )
+	{
+		if( *buffers[b] )
+		{
+			cudaFree( *buffers[b] );
+			*buffers[b] = 0;
+		}
+	}
+	return cudaMalloc( &arena_, arena.size() ) == cudaSuccess
+		&& cudaMalloc( &offsets_, offsets.size()
+			* sizeof( unsigned long long ) ) == cudaSuccess
+		&& cudaMalloc( &dlengths_, lengths_.size() * sizeof( int ) )
+			== cudaSuccess
+		&& cudaMemcpy( arena_, &arena[0], arena.size(),
+			cudaMemcpyHostToDevice ) == cudaSuccess
+		&& cudaMemcpy( offsets_, &offsets[0], offsets.size()
+			* sizeof( unsigned long long ), cudaMemcpyHostToDevice )
+			== cudaSuccess
+		&& cudaMemcpy( dlengths_, &lengths_[0], lengths_.size()
+			* sizeof( int ), cudaMemcpyHostToDevice ) == cudaSuccess;
+}
+
+/******************************************************************************/
+
+// align a list of pairs, DEVICEPAIRS at a time, appending the significant ones
+//	to edges and those too long for the device to rest
+
+bool device::align( const vector< pair<int, int> >& pairs,
+	vector< pair<int, int> >& edges, vector< pair<int, int> >& rest )
+{
+	if( !available_ || !arena_ )
+	{
+		return false;
+	}
+
+	vector<int> launch, found;
+	launch.reserve( 2 * DEVICEPAIRS );
+	int n = static_cast<int>( pairs.size() );
+
+	for( int k = 0; k < n; )
+	{
+		// the pairs of the launch, and the longest x-sequence
+		launch.clear();
+		int longest = 0;
+		for( ; k < n && static_cast<int>( launch.size() ) < 2 * DEVICEPAIRS;
+			k++ )
+		{
+			int x = pairs[k].first, y = pairs[k].second;
+			if( lengths_[x] > DEVICEMAXLEN )
+			{
+				rest.push_back( pairs[k] );
+				continue;
+			}
+			if( lengths_[x] < 1 || lengths_[y] < 1 )
+			{
+				continue;
+			}
+			launch.push_back( x );
+			launch.push_back( y );
+			longest = max( longest, lengths_[x] );
+		}
+		int count = static_cast<int>( launch.size() ) / 2;
+		if( count == 0 )
+		{
+			continue;
+		}
+
+		int zero = 0;
+		size_t shared = 7 * ( longest + 1 ) * sizeof( int ) + longest;
+		if( cudaMemcpy( pairs_, &launch[0], launch.size() * sizeof( int ),
+				cudaMemcpyHostToDevice ) != cudaSuccess
+			|| cudaMemcpy( count_, &zero, sizeof( int ),
+				cudaMemcpyHostToDevice ) != cudaSuccess )
+		{
+			return false;
+		}
+		alignpairs<<< count, DEVICETHREADS, shared >>>(
+			static_cast<const unsigned char*>( arena_ ),
+			static_cast<const unsigned long long*>( offsets_ ),
+			static_cast<const int*>( dlengths_ ),
+			static_cast<const int*>( dsubst_ ), go_, gx_, stop_,
+			static_cast<const int*>( pairs_ ), count,
+			static_cast<int*>( edges_ ), static_cast<int*>( count_ ) );
+
+		// only the significant pairs are copied back
+		int significant = 0;
+		if( cudaGetLastError() != cudaSuccess
+			|| cudaMemcpy( &significant, count_, sizeof( int ),
+				cudaMemcpyDeviceToHost ) != cudaSuccess )
+		{
+			return false;
+		}
+		found.resize( 2 * significant + 1 );
+		if( significant > 0 && cudaMemcpy( &found[0], edges_,
+			2 * significant * sizeof( int ),
+			cudaMemcpyDeviceToHost ) != cudaSuccess )
+		{
+			return false;
+		}
+		for( int e = 0; e < significant; e++ )
+		{
+			edges.push_back( pair<int, int>( found[2*e],
+				found[2*e+1] ) );
+		}
+	}
+	return true;
+}
+
+#else
+
+/******************************************************************************/
+
+// without CUDA there is never a device, and nothing is aligned
+
+device::device( void )
+	:
+	available_( false ),
+	name_( "none" ),
+	go_( 0 ), gx_( 0 ), stop_( 0 ),
+	arena_( 0 ), offsets_( 0 ), dlengths_( 0 ), dsubst_( 0 ), pairs_( 0 ),
+	edges_( 0 ), count_( 0 )
+{
+}
+
+bool device::open( void )
+{
+	return false;
+}
+
+device::~device()
+{
+}
+
+void device::release( void )
+{
+}
+
+bool device::scoring( const dynamic& )
+{
+	return false;
+}
+
+bool device::upload( const vector<dna>& )
+{
+	return false;
+}
+
+bool device::align( const vector< pair<int, int> >&,
+	vector< pair<int, int> >&, vector< pair<int, int> >& )
+{
+	return false;
+}
+
+#endif
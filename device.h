@@ -0,0 +1,133 @@
+	/*
+File:		device.h
+Title:		Class declaration for class "device", the GPU backend of the
+		all-pairs alignments.
+
+Description:
+
+1. OVERVIEW
+
+	For the largest libraries the n(n-1)/2 alignments of exest take most of
+its time, even on all the processors. The device class aligns lists of pairs
+on a CUDA device (a GPU) instead, and gives back the significant ones: the
+same edges as those of the dynamic class in DYNSCORE mode (see dynamic.h),
+which are clustered on the host as usual (see allpairs.h). It is only
+compiled in with CUDA (make CUDA=1); without it, or without a device, there
+is no device, and allpairs aligns all the pairs on the CPU.
+
+2. DATA MEMBERS
+
+	2.1. SEQUENCES
+
+	The sequences are uploaded once, before their pairs are aligned, as an
+arena of nucleotide codes packed two per byte, one sequence after the other,
+with the offset (in nucleotides) and the length of each.
+
+	2.2. SCORES
+
+	The device uses the integer scores of the vectorized kernel (see
+dynamic.h, integral()), so the significance of a pair is exactly that it has
+on the CPU. Scores that are not integral once scaled can not be used.
+
+	2.3. ALIGNMENTS
+
+	Each pair is aligned by one block of threads, the cells of each
+anti-diagonal of its matrix (which do not depend on each other) being computed
+by all the threads at once. The three last anti-diagonals of H and the two last
+of E and F, and the x-sequence, are kept in the shared memory of the block,
+which limits the length of the x-sequences to DEVICEMAXLEN. An alignment stops
+as soon as it reaches the significance threshold. Only the significant pairs
+are copied back to the host.
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR
+
+	The constructor creates an object without a device: open() looks for
+one, so that the programs only start CUDA when asked to.
+
+	3.2. OTHER FUNCTIONS
+
+		- open(): looks for a device, and uses the first one. Returns
+	false if there is none (always without CUDA).
+		- available(): is there a device?
+		- name(): the name of the device, or "none".
+		- scoring(): sets the scores of a dynamic object. Returns false if
+	they are not integral.
+		- upload(): copies the sequences to the device (see 2.1).
+		- align(): aligns a list of pairs of the sequences uploaded, and
+	appends the significant ones to a vector of edges. The pairs with an
+	x-sequence longer than DEVICEMAXLEN are appended to another vector,
+	to be aligned on the CPU. Returns false if the device failed, in which
+	case none of the pairs should be taken as aligned.
+
+4. NOTES
+
+	The X-drop mode and the bands of dynamic are not used on the device:
+the first only saves time, and the pairs with a band are aligned on the CPU
+(see allpairs.h).
+
+	*/
+
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include "dna.h"
+#include "dynamic.h"
+
+const int DEVICEMAXLEN = 1536;		// the longest x-sequence on the device
+const int DEVICEPAIRS = 1 << 18;	// the pairs aligned per launch
+const int DEVICETHREADS = 128;		// the threads of a block
+
+class device
+{
+	public:
+		// constructor, destructor
+		device( void );
+		~device();
+
+		// "get" functions
+		bool available( void ) const { return available_; }
+		const string& name( void ) const { return name_; }
+
+		// "set" functions
+		bool scoring( const dynamic& );
+
+		// other functions
+		bool open( void );
+		bool upload( const vector<dna>& );
+		bool align( const vector< pair<int, int> >&,
+			vector< pair<int, int> >&, vector< pair<int, int> >& );
+
+	private:
+		// copying is not supported
+		device( const device& );
+		device& operator=( const device& );
+
+		// free the buffers of the device
+		void release( void );
+
+		bool available_;	// is there a device?
+		string name_;		// its name
+
+		vector<int> lengths_;	// the lengths of the sequences uploaded
+		int subst_[DNACODES * DNACODES];	// the integer scores
+		int go_, gx_;		// the gap penalties
+		int stop_;		// the significance threshold
+
+		// the buffers on the device (see 2.1): the arena, the offsets
+		// and lengths of the sequences, the scores, the pairs and the
+		// edges of a launch, and the number of edges
+		void* arena_;
+		void* offsets_;
+		void* dlengths_;
+		void* dsubst_;
+		void* pairs_;
+		void* edges_;
+		void* count_;
+};
+
+#endif
@@ -0,0 +1,295 @@
+	/*
+File:		diskcache.cpp
+Title:		Class definitions for class "diskcache" (declared in
+		diskcache.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "cache.h"
+#include "dna.h"
+#include "dynamic.h"
+#include "diskcache.h"
+
+const size_t DISKHEADER = 8;		// the size of DISKMAGIC in the file
+const size_t DISKRECORD = sizeof( cacheword );
+
+/******************************************************************************/
+
+// write the whole of a buffer to a file descriptor. Returns false on a write
+//	error.
+
+static bool writeall( int fd, const void* data, size_t size )
+{
+	const char* p = static_cast<const char*>( data );
+
+	while( size > 0 )
+	{
+		ssize_t put = write( fd, p, size );
+		if( put < 0 && errno == EINTR )
+		{
+			continue;
+		}
+		if( put <= 0 )
+		{
+			return false;
+		}
+		p += put;
+		size -= put;
+	}
+	return true;
+}
+
+/******************************************************************************/
+
+// the bits of a float, for hashing
+
+static cacheword bits( float f )
+{
+	unsigned int u;
+	memcpy( &u, &f, sizeof( u ) );
+	return u;
+}
+
+/******************************************************************************/
+
+// constructor for class diskcache
+
+diskcache::diskcache( void )
+	:
+	fd_( -1 ),
+	map_( 0 ),
+	mapsize_( 0 ),
+	records_( 0 ),
+	count_( 0 ),
+	signature_( 0 ),
+	added_( 0 )
+{
+}
+
+/******************************************************************************/
+
+// destructor for class diskcache: write the buffered records, and close the
+//	file
+
+diskcache::~diskcache()
+{
+	flush();
+	if( map_ )
+	{
+		munmap( map_, mapsize_ );
+	}
+	if( fd_ >= 0 )
+	{
+		close( fd_ );
+	}
+}
+
+/******************************************************************************/
+
+// open (or create) a cache file for a set of sequences and a signature of
+//	the alignment parameters, and load its records
+
+bool diskcache::open( const string& file, const vector<dna>& s, cacheword sg )
+{
+	fd_ = ::open( file.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644 );
+	if( fd_ < 0 )
+	{
+		return false;
+	}
+
+	struct stat st;
+	if( fstat( fd_, &st ) != 0 )
+	{
+		return shut();
+	}
+	size_t size = st.st_size;
+
+	// a new file only gets the header
+	if( size == 0 )
+	{
+		if( !writeall( fd_, DISKMAGIC, DISKHEADER ) )
+		{
+			return shut();
+		}
+		size = DISKHEADER;
+	}
+
+	char magic[DISKHEADER];
+	if( size < DISKHEADER || pread( fd_, magic, DISKHEADER, 0 )
+		!= static_cast<ssize_t>( DISKHEADER )
+		|| memcmp( magic, DISKMAGIC, DISKHEADER ) != 0 )
+	{
+		return shut();
+	}
+
+	// drop the end of a record cut short, so that the next records are
+	// appended whole
+	count_ = ( size - DISKHEADER ) / DISKRECORD;
+	if( DISKHEADER + count_ * DISKRECORD != size )
+	{
+		size = DISKHEADER + count_ * DISKRECORD;
+		if( ftruncate( fd_, size ) != 0 )
+		{
+			return shut();
+		}
+	}
+
+	// map the records privately, so that they can be sorted without
+	// touching the file
+	if( count_ > 0 )
+	{
+		void* p = mmap( 0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fd_, 0 );
+		if( p == MAP_FAILED )
+		{
+			return shut();
+		}
+		map_ = static_cast<char*>( p );
+		mapsize_ = size;
+		records_ = reinterpret_cast<cacheword*>( map_ + DISKHEADER );
+		sort( records_, records_ + count_ );
+	}
+
+	signature_ = sg;
+	hashes_.resize( s.size() );
+	for( int i = 0; i < static_cast<int>( s.size() ); i++ )
+	{
+		hashes_[i] = hash( s[i] );
+	}
+	return true;
+}
+
+/******************************************************************************/
+
+// close the file after a failed open(). Returns false, for open() to return.
+
+bool diskcache::shut( void )
+{
+	close( fd_ );
+	fd_ = -1;
+	count_ = 0;
+	return false;
+}
+
+/******************************************************************************/
+
+// the signature of the alignment parameters of a dynamic object, with a
+//	bandwidth and the value of k of the k-mers placing the band
+
+cacheword diskcache::signature( const dynamic& d, int bw, int k )
+{
+	cacheword sg = 0;
+
+	sg = cache::hash( sg ^ bits( d.match() ) );
+	sg = cache::hash( sg ^ bits( d.msmatch() ) );
+	sg = cache::hash( sg ^ bits( d.gapopen() ) );
+	sg = cache::hash( sg ^ bits( d.gapxtnd() ) );
+	sg = cache::hash( sg ^ static_cast<cacheword>( d.significance() ) );
+	sg = cache::hash( sg ^ bits( d.xdrop() ) );
+
+	// unbanded alignments do not depend on the k-mers
+	if( bw >= 0 )
+	{
+		sg = cache::hash( sg ^ ( static_cast<cacheword>( bw ) << 8 )
+			^ static_cast<cacheword>( k ) );
+	}
+	return sg;
+}
+
+/******************************************************************************/
+
+// the hash of a sequence: FNV-1a of its nucleotide codes, mixed with its
+//	length
+
+cacheword diskcache::hash( const dna& s )
+{
+	vector<unsigned char> codes( s.length() + 1 );
+	s.unpack( &codes[0] );
+
+	cacheword h = 0xcbf29ce484222325ULL;
+	for( int i = 0; i < s.length(); i++ )
+	{
+		h = ( h ^ codes[i] ) * 0x100000001b3ULL;
+	}
+	return cache::hash( h ^ static_cast<cacheword>( s.length() ) );
+}
+
+/******************************************************************************/
+
+// the key of a pair of sequences (the same for (i, j) and (j, i)), with the
+//	result bit clear
+
+cacheword diskcache::key( int i, int j ) const
+{
+	cacheword a = hashes_[i], b = hashes_[j];
+	if( a > b )
+	{
+		cacheword t = a;
+		a = b;
+		b = t;
+	}
+	return cache::hash( cache::hash( a ^ signature_ ) + b ) & ~1ULL;
+}
+
+/******************************************************************************/
+
+// look up the result of a pair among the records read from the file
+
+int diskcache::find( int i, int j ) const
+{
+	if( count_ == 0 )
+	{
+		return CACHEMISS;
+	}
+
+	cacheword k = key( i, j );
+	const cacheword* pos = lower_bound( records_, records_ + count_, k );
+	if( pos == records_ + count_ || ( *pos & ~1ULL ) != k )
+	{
+		return CACHEMISS;
+	}
+	return ( *pos & 1 ) ? CACHEYES : CACHENO;
+}
+
+/******************************************************************************/
+
+// record the result of a pair, to be appended to the file
+
+void diskcache::insert( int i, int j, bool e )
+{
+	if( fd_ < 0 )
+	{
+		return;
+	}
+	buffer_.push_back( key( i, j ) | ( e ? 1 : 0 ) );
+	added_++;
+	if( static_cast<int>( buffer_.size() ) >= DISKBUFFER )
+	{
+		flush();
+	}
+}
+
+/******************************************************************************/
+
+// append the buffered records to the file. A failed write only loses them for
+//	later runs.
+
+void diskcache::flush( void )
+{
+	if( fd_ >= 0 && !buffer_.empty() )
+	{
+		writeall( fd_, &buffer_[0], buffer_.size() * DISKRECORD );
+	}
+	buffer_.clear();
+}
@@ -0,0 +1,129 @@
+	/*
+File:		diskcache.h
+Title:		Class declaration for class "diskcache", a persistent store of
+		alignment results.
+
+Description:
+
+1. OVERVIEW
+
+	The cache class (see cache.h) only lasts for one run of gaest, so
+rerunning it on the same ESTs (e.g. to try other GA parameters) aligns the same
+pairs again. The diskcache class keeps the results in a file: the file is
+mapped into memory when it is opened, the results of the pairs aligned since
+are appended to it, and they can be looked up by later runs.
+
+2. DATA MEMBERS
+
+	2.1. KEYS
+
+	A pair is identified by the contents of its sequences, not by their
+indices, so the file stays valid when sequences are added, removed or
+reordered. Each sequence is hashed (its nucleotides and length; the name is
+left out) when the file is opened, and the key of a pair combines the hashes of
+its two sequences (in either order) with a signature of the alignment
+parameters: the rewards, penalties, significance length, X-drop value and
+bandwidth. Results computed with other parameters are thus never found. The
+key is 64 bits wide, and its lowest bit holds the result, so a record takes 8
+bytes.
+
+	2.2. FILE
+
+	The file starts with the 8 characters DISKMAGIC, followed by the records
+in the order they were written. When the file is opened, it is mapped
+privately (copy-on-write) and the records are sorted in memory for binary
+search; the file itself is not modified, other than by appending. New
+records are buffered and appended DISKBUFFER at a time, when flush() is called
+and when the object is destroyed. A record cut short by a crash is dropped
+when the file is next opened.
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR, DESTRUCTOR
+
+	The constructor creates a closed cache, in which nothing is found. The
+destructor writes the buffered records and closes the file.
+
+	3.2. OTHER FUNCTIONS
+
+		- open(): opens (or creates) a file for a set of sequences and a
+	parameter signature. Returns false if the file can not be opened, or is
+	not a cache file.
+		- signature(): the signature of the alignment parameters of a
+	dynamic object (see dynamic.h), banded alignments also depending on the
+	value of k of the k-mers finding their diagonal (see kmer.h).
+		- find(): returns CACHEYES or CACHENO (see cache.h) if the result
+	of a pair was in the file when it was opened, and CACHEMISS otherwise.
+		- insert(): records the result of a pair.
+		- flush(): appends the records buffered to the file.
+		- size(), added(): the number of records read, and written.
+
+4. NOTES
+
+	Unlike cache, diskcache is not thread-safe. Several runs can append to
+the same file at once (the records are written whole, in append mode), but a
+run only finds the records written before it started. A pair aligned by two
+runs is simply stored twice.
+
+	The records are in the byte order of the machine that wrote them.
+
+	*/
+
+#ifndef DISKCACHE_H
+#define DISKCACHE_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "cache.h"
+#include "dna.h"
+#include "dynamic.h"
+
+const char DISKMAGIC[] = "GAESTDC1";	// the first 8 bytes of a cache file
+const int DISKBUFFER = 4096;	// records buffered before writing
+
+class diskcache
+{
+	public:
+		// constructor, destructor
+		diskcache( void );
+		~diskcache();
+
+		// "get" functions
+		int find( int, int ) const;
+		double size( void ) const { return static_cast<double>( count_ ); }
+		double added( void ) const { return added_; }
+		static cacheword signature( const dynamic&, int, int );
+
+		// other functions
+		bool open( const string&, const vector<dna>&, cacheword );
+		void insert( int, int, bool );
+		void flush( void );
+
+	private:
+		// the key of a pair (with the result bit clear)
+		cacheword key( int, int ) const;
+
+		// the hash of a sequence
+		static cacheword hash( const dna& );
+
+		// close the file when it can not be used
+		bool shut( void );
+
+		// no copying
+		diskcache( const diskcache& );
+		diskcache& operator=( const diskcache& );
+
+		int fd_;		// the file, or -1
+		char* map_;		// the mapping of the file
+		size_t mapsize_;	// and its size
+		cacheword* records_;	// the sorted records in the mapping
+		size_t count_;		// and their number
+
+		cacheword signature_;	// the signature of the parameters
+		vector<cacheword> hashes_;	// the hash of each sequence
+		vector<cacheword> buffer_;	// the records to append
+		double added_;		// the number of records written
+};
+
+#endif
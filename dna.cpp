@@ -19,7 +19,6 @@ Description:	See class declaration for description of friend and member
 
 istream& operator>>( istream& input, dna& s )
 {
-	int i = 0;	// general use index int
 	char c;		// temporary input char
 
 	// skip characters until the signal '>'
@@ -31,14 +30,15 @@ istream& operator>>( istream& input, dna& s )
 		return input;
 	}
 
-	// erase the current contents of the objects
+	// erase the current contents of the objects, and use the current
+	// packing for the new sequence
 	s.name_.erase();
-	s.sequence_.clear();
-	s.length_ = 0;
+	s.nameptr_ = 0;
+	s.reset();
 
-	// reserve a minimum amount of starting memory for name and sequence
-	s.name_.resize( DNANAME );
-	s.sequence_.reserve( DNASEQ );
+	// reserve a minimum amount of starting memory for the sequence (the
+	// name grows as needed, and is left exactly as long as read)
+	s.sequence_.reserve( s.pack_ == PACK4 ? DNASEQ/2 : DNASEQ/4 );
 
 	// input the name
 	while( input.get(c) )
@@ -50,13 +50,7 @@ istream& operator>>( istream& input, dna& s )
 			if( input.peek() == '>' )
 			{
 				input.get(c);
-				// check that the size has not been exceeded
-				if( i == static_cast<int> (s.name_.size()) )
-				{
-					s.name_.resize( i*2 );
-				}
-				s.name_[i] = ' ';
-				i++;
+				s.name_ += ' ';
 				continue;
 			}
 			// if the character immediately following the newline
@@ -66,12 +60,7 @@ istream& operator>>( istream& input, dna& s )
 				break;
 			}
 		}
-		if( i == static_cast<int>( s.name_.size() ) )
-		{
-			s.name_.resize( i*2 );
-		}
-		s.name_[i] = c;
-		i++;
+		s.name_ += c;
 	}
 
 	// Then input the sequence
@@ -95,10 +84,9 @@ istream& operator>>( istream& input, dna& s )
 		// nucleotide
 		if( s.valid_[c] != X )
 		{
-			s.sequence_.push_back( s.valid_[c] );
+			s.push( s.valid_[c] );
 		}
 	}
-	s.length_ = s.sequence_.size();
 
 	// This allows the last sequence to be read in a while-loop's condition
 	// statement (e.g. while( cin >> dna1 )). Without the clear() statement
@@ -117,7 +105,7 @@ istream& operator>>( istream& input, dna& s )
 ostream& operator<<( ostream& output, const dna& s )
 {
 	// First output the name with a signal '>' in front
-	output	<< ">" << s.name_;
+	output	<< ">" << s.name();
 
 	// if the wrap is set to 0 or less, return
 	if( s.wrap_ < 1 )
@@ -146,7 +134,7 @@ ostream& operator<<( ostream& output, const dna& s )
 			}
 			// print the char corresponding to the current
 			// nucleotide
-			output	<< ( s.nucprint_[ s.sequence_[i] ] );
+			output	<< s.letter(i);
 		}
 		output	<< endl;
 	}
@@ -163,7 +151,7 @@ ostream& operator<<( ostream& output, const dna& s )
 			}
 			// output the char corresponding to the current
 			// nucleotide
-			output	<< ( s.nucprint_[ s.sequence_[i] ] );
+			output	<< s.letter(i);
 		}
 	}
 
@@ -173,7 +161,7 @@ ostream& operator<<( ostream& output, const dna& s )
 		output	<< endl;
 		for( int i = 0; i < s.length_; i++ )
 		{
-			output	<< ( s.nucprint_[ s.sequence_[i] ] );
+			output	<< s.letter(i);
 		}
 	}
 
@@ -204,10 +192,11 @@ double compare( const nucleotide& n1, const nucleotide& n2 )
 	vector<nucleotide> dna::valid_( DNAASCII, X );
 
 	// 2D vector defining the match strengths between nucleotides
-	vector< vector<double> > dna::matching_( DNAALPHA, DNAALPHA );
+	vector< vector<double> > dna::matching_( DNACODES,
+		vector<double>( DNACODES ) );
 
 	// vector mapping nucleotides to corresponding chars
-	vector<char> dna::nucprint_( DNAALPHA );
+	vector<char> dna::nucprint_( DNACODES );
 
 	// a data type to specify printing mode for DNA sequences
 	printmode dna::pmode_( NICE );
@@ -221,6 +210,12 @@ double compare( const nucleotide& n1, const nucleotide& n2 )
 	// definition of the initialization flag
 	bool dna::init_( false );
 
+	// the packing of new sequences
+	packmode dna::packing_( PACK4 );
+
+	// the nucleotides corresponding to the 2-bit codes of PACK2
+	const nucleotide dna::bases_[4] = { A, C, G, T };
+
 /******************************************************************************/
 
 // default constructor for class dna
@@ -228,7 +223,14 @@ double compare( const nucleotide& n1, const nucleotide& n2 )
 dna::dna( void )
 	:
 	sequence_( 0 ),
-	length_( 0 )
+	pack_( packing_ ),
+	length_( 0 ),
+	packed_( 0 ),
+	ambiglist_( 0 ),
+	ambigs_( 0 ),
+	view_( false ),
+	nameptr_( 0 ),
+	namelen_( 0 )
 {
 	// hardcode nucleotide alphabet equivalences if nor initialized before
 	if( !init_ )
@@ -282,6 +284,36 @@ dna& dna::operator=( const dna& d1 )
 
 /******************************************************************************/
 
+// exchange two values of a member
+
+template <class T> static inline void exchange( T& a, T& b )
+{
+	T t( a );
+	a = b;
+	b = t;
+}
+
+// exchange the contents of two dna objects. The vectors exchange their buffers,
+//	so the sequence pointers of both objects stay valid whether or not
+//	they are views
+
+void dna::swap( dna& d1 )
+{
+	name_.swap( d1.name_ );
+	sequence_.swap( d1.sequence_ );
+	ambig_.swap( d1.ambig_ );
+	exchange( pack_, d1.pack_ );
+	exchange( length_, d1.length_ );
+	exchange( packed_, d1.packed_ );
+	exchange( ambiglist_, d1.ambiglist_ );
+	exchange( ambigs_, d1.ambigs_ );
+	exchange( view_, d1.view_ );
+	exchange( nameptr_, d1.nameptr_ );
+	exchange( namelen_, d1.namelen_ );
+}
+
+/******************************************************************************/
+
 // return the specified nucleotide
 
 nucleotide dna::operator[]( int i ) const
@@ -295,30 +327,179 @@ nucleotide dna::operator[]( int i ) const
 			<< "; Tried to access:" << i << endl;
 		exit( EXIT_FAILURE );
 	}
-	return sequence_[i];
+	return get(i);
 }
 
 /******************************************************************************/
 
-// set the sequence to a specified string
+// write the nucleotide codes of the sequence into an array of at least
+// length() bytes
 
-void dna::sequence( string s )
+void dna::unpack( unsigned char* codes ) const
 {
-	// clear the current contents of the sequence.
-	sequence_.clear();
+	int i;		// general use index int
+
+	if( pack_ == PACK4 )
+	{
+		// two nucleotides per byte, the first in the low nibble
+		for( i = 0; i+1 < length_; i += 2 )
+		{
+			codes[i] = packed_[i >> 1] & 0xf;
+			codes[i+1] = packed_[i >> 1] >> 4;
+		}
+		if( i < length_ )
+		{
+			codes[i] = packed_[i >> 1] & 0xf;
+		}
+		return;
+	}
+
+	// four bases per byte in PACK2, the first in the lowest bits
+	for( i = 0; i < length_; i++ )
+	{
+		codes[i] = bases_[ ( packed_[i >> 2] >> ( ( i & 3 ) << 1 ) )
+			& 3 ];
+	}
+
+	// then overwrite the positions of the ambiguous nucleotides
+	for( i = 0; i < ambigs_; i++ )
+	{
+		codes[ ambiglist_[i].first ] = ambiglist_[i].second;
+	}
+}
+
+/******************************************************************************/
 
-	// set the length
-	length_ = static_cast<int> (s.length());
+// are all the nucleotides of the sequence bases? In PACK2 the other ones are
+// those of the list of ambiguous nucleotides, and in PACK4 a base is a code
+// with a single bit set
+
+bool dna::bases( void ) const
+{
+	if( pack_ == PACK2 )
+	{
+		return ambigs_ == 0;
+	}
 
-	// set the sequence
 	for( int i = 0; i < length_; i++ )
+	{
+		int c = ( packed_[i >> 1] >> ( ( i & 1 ) << 2 ) ) & 0xf;
+		if( c == 0 || ( c & ( c - 1 ) ) != 0 )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/******************************************************************************/
+
+// the nucleotide corresponding to a character (X if it is not valid)
+
+nucleotide dna::valid( char c )
+{
+	// verify that the valid characters have been initialized
+	if( !init_ )
+	{
+		dna d;
+	}
+
+	unsigned char u = static_cast<unsigned char>( c );
+	return ( u < DNAASCII ) ? valid_[u] : X;
+}
+
+/******************************************************************************/
+
+// empty the sequence, which uses the current packing and the object's own
+//	vectors from now on
+
+void dna::reset( void )
+{
+	sequence_.clear();
+	ambig_.clear();
+	length_ = 0;
+	pack_ = packing_;
+	own();
+}
+
+/******************************************************************************/
+
+// point the sequence pointers at the object's own vectors (which may have been
+//	reallocated)
+
+void dna::own( void )
+{
+	packed_ = sequence_.empty() ? 0 : &sequence_[0];
+	ambiglist_ = ambig_.empty() ? 0 : &ambig_[0];
+	ambigs_ = static_cast<int>( ambig_.size() );
+	view_ = false;
+}
+
+/******************************************************************************/
+
+// append a nucleotide to the end of the packed sequence (which must not be a
+//	view)
+
+void dna::push( nucleotide n )
+{
+	if( pack_ == PACK4 )
+	{
+		if( ( length_ & 1 ) == 0 )
+		{
+			sequence_.push_back( n );
+		}
+		else
+		{
+			sequence_[length_ >> 1] |= n << 4;
+		}
+		length_++;
+		own();
+		return;
+	}
+
+	// in PACK2 store the 2-bit code of the base, and keep any other
+	// nucleotide in the list of ambiguous nucleotides (stored as code 0)
+	int code = 0;
+	switch( n )
+	{
+		case A: code = 0; break;
+		case C: code = 1; break;
+		case G: code = 2; break;
+		case T: code = 3; break;
+		default: ambig_.push_back( pair<int, nucleotide>( length_, n ) );
+	}
+	if( ( length_ & 3 ) == 0 )
+	{
+		sequence_.push_back( code );
+	}
+	else
+	{
+		sequence_[length_ >> 2] |= code << ( ( length_ & 3 ) << 1 );
+	}
+	length_++;
+	own();
+}
+
+/******************************************************************************/
+
+// set the sequence to a specified string
+
+void dna::sequence( string s )
+{
+	// clear the current contents of the sequence, and use the current
+	// packing for the new sequence
+	reset();
+
+	// set the sequence. The length is kept by push(), so that discarded
+	// characters are not counted
+	for( int i = 0; i < static_cast<int> (s.length()); i++ )
 	{
 		// convert lowercase to uppercase
 		s[i] = toupper( s[i] );
 		// discard invalid characters
 		if( valid_[s[i]] != X )
 		{
-			sequence_.push_back( valid_[s[i]] );
+			push( valid_[s[i]] );
 		}
 	}
 
@@ -327,13 +508,90 @@ void dna::sequence( string s )
 
 /******************************************************************************/
 
+// set the sequence from an array of n nucleotide codes (none of them X)
+
+void dna::sequence( const unsigned char* codes, int n )
+{
+	reset();
+	pack( codes, n, pack_, sequence_, ambig_ );
+	length_ = n;
+	own();
+}
+
+/******************************************************************************/
+
+// append n nucleotide codes (none of them X) to a packed sequence in the given
+//	packing, starting on a new byte, and their ambiguous nucleotides to a
+//	list (PACK2 only). The positions in the list start at 0, whatever was
+//	in the vectors before.
+
+void dna::pack( const unsigned char* codes, int n, packmode p,
+	vector<unsigned char>& packed, vector< pair<int, nucleotide> >& ambig )
+{
+	int start = static_cast<int>( packed.size() );
+	int i;
+
+	if( p == PACK4 )
+	{
+		packed.resize( start + ( n + 1 ) / 2 );
+		unsigned char* out = &packed[0] + start;
+		for( i = 0; i+1 < n; i += 2 )
+		{
+			out[i >> 1] = codes[i] | ( codes[i+1] << 4 );
+		}
+		if( i < n )
+		{
+			out[i >> 1] = codes[i];
+		}
+		return;
+	}
+
+	// in PACK2 the nucleotides other than the bases are stored as code 0,
+	// and listed
+	packed.resize( start + ( n + 3 ) / 4, 0 );
+	unsigned char* out = &packed[0] + start;
+	for( i = 0; i < n; i++ )
+	{
+		int code = 0;
+		switch( codes[i] )
+		{
+			case A: code = 0; break;
+			case C: code = 1; break;
+			case G: code = 2; break;
+			case T: code = 3; break;
+			default: ambig.push_back( pair<int, nucleotide>
+				( i, static_cast<nucleotide>( codes[i] ) ) );
+		}
+		out[i >> 2] |= code << ( ( i & 3 ) << 1 );
+	}
+}
+
+/******************************************************************************/
+
 // copy an input dna sequence to the calling sequence
 
 void dna::copy( const dna& d1 )
 {
 	name_ = d1.name_;
-	sequence_ = d1.sequence_;
+	nameptr_ = d1.nameptr_;
+	namelen_ = d1.namelen_;
+	pack_ = d1.pack_;
 	length_ = d1.length_;
+
+	// a view is copied as a view, i.e. only the pointers are copied
+	if( d1.view_ )
+	{
+		sequence_.clear();
+		ambig_.clear();
+		packed_ = d1.packed_;
+		ambiglist_ = d1.ambiglist_;
+		ambigs_ = d1.ambigs_;
+		view_ = true;
+		return;
+	}
+	sequence_ = d1.sequence_;
+	ambig_ = d1.ambig_;
+	own();
 }
 
 /******************************************************************************/
@@ -371,86 +629,34 @@ void dna::valid_init( void )
 
 /******************************************************************************/
 
-// hardcode the match strengths of different nucleotides. Sorted by decreasing
-// match strength, and by nucleotide order (i.e. the number of actual
-// nucleotides represented by the symbol)
+// calculate the match strengths of the nucleotides from their bits: the
+// strength is the probability that the bases represented by each of the two
+// nucleotides are the same (e.g. R-D is 2/(2*3) = 1/3, since A and G are
+// common to both)
 
 void dna::match_init( void )
 {
-	matching_[A][A] = matching_[C][C] = matching_[G][G] = matching_[T][T]
-	= 1.0;
-
-	matching_[A][R] = matching_[A][W] = matching_[A][M]
-	= matching_[R][A] = matching_[W][A] = matching_[M][A]
-	= matching_[C][Y] = matching_[C][S] = matching_[C][M]
-	= matching_[Y][C] = matching_[S][C] = matching_[M][C]
-	= matching_[G][R] = matching_[G][S] = matching_[G][K]
-	= matching_[R][G] = matching_[S][G] = matching_[K][G]
-	= matching_[T][Y] = matching_[T][W] = matching_[T][K]
-	= matching_[Y][T] = matching_[W][T] = matching_[K][T]
-	= 0.5;
-
-	matching_[R][R] = matching_[Y][Y] = matching_[K][K] = matching_[M][M]
-	= matching_[S][S] = matching_[W][W]
-	= 0.5;
-
-	matching_[A][D] = matching_[A][H] = matching_[A][V]
-	= matching_[D][A] = matching_[H][A] = matching_[V][A]
-	= matching_[C][B] = matching_[C][H] = matching_[C][V]
-	= matching_[B][C] = matching_[H][C] = matching_[V][C]
-	= matching_[G][B] = matching_[G][D] = matching_[G][V]
-	= matching_[B][G] = matching_[D][G] = matching_[V][G]
-	= matching_[T][B] = matching_[T][D] = matching_[T][H]
-	= matching_[B][T] = matching_[D][T] = matching_[H][T]
-	= 1/3;
-
-	matching_[R][D] = matching_[R][V]
-	= matching_[D][R] = matching_[V][R]
-	= matching_[Y][B] = matching_[Y][H]
-	= matching_[B][Y] = matching_[H][Y]
-	= matching_[K][B] = matching_[K][D]
-	= matching_[B][K] = matching_[D][K]
-	= matching_[M][H] = matching_[M][V]
-	= matching_[H][M] = matching_[V][M]
-	= matching_[S][B] = matching_[S][V]
-	= matching_[B][S] = matching_[V][S]
-	= matching_[W][D] = matching_[W][H]
-	= matching_[D][W] = matching_[H][W]
-	= 1/3;
-
-	matching_[B][B] = matching_[D][D] = matching_[H][H] = matching_[V][V]
-	= 1/3;
-
-	matching_[A][N] = matching_[C][N] = matching_[G][N] = matching_[T][N]
-	= matching_[N][A] = matching_[N][C] = matching_[N][G] = matching_[N][T]
-	= 0.25;
-
-	matching_[R][N] = matching_[Y][N] = matching_[K][N] = matching_[M][N]
-	= matching_[N][R] = matching_[N][Y] = matching_[N][K] = matching_[N][M]
-	= matching_[S][N] = matching_[W][N]
-	= matching_[N][S] = matching_[N][W]
-	= 0.25;
-
-	matching_[B][N] = matching_[D][N] = matching_[H][N] = matching_[V][N]
-	= matching_[N][B] = matching_[N][D] = matching_[N][H] = matching_[N][V]
-	= 0.25;
-
-	matching_[N][N] = 0.25;
-
-	matching_[R][B] = matching_[R][H]
-	= matching_[B][R] = matching_[H][R]
-	= matching_[Y][D] = matching_[Y][V]
-	= matching_[D][Y] = matching_[V][Y]
-	= matching_[K][H] = matching_[K][V]
-	= matching_[H][K] = matching_[V][K]
-	= matching_[M][B] = matching_[M][D]
-	= matching_[B][M] = matching_[D][M]
-	= matching_[S][D] = matching_[S][H]
-	= matching_[D][S] = matching_[H][S]
-	= matching_[W][B] = matching_[W][V]
-	= matching_[B][W] = matching_[V][W]
-	= 1/6;
+	int bits[DNACODES];	// the number of bases in each nucleotide
+
+	for( int a = 0; a < DNACODES; a++ )
+	{
+		bits[a] = 0;
+		for( int b = a; b > 0; b >>= 1 )
+		{
+			bits[a] += b & 1;
+		}
+	}
 
+	for( int a = 0; a < DNACODES; a++ )
+	{
+		for( int b = 0; b < DNACODES; b++ )
+		{
+			// X (no bits) matches nothing
+			matching_[a][b] = ( a == X || b == X ) ? 0.0 :
+				static_cast<double> ( bits[a & b] )
+				/ ( bits[a] * bits[b] );
+		}
+	}
 }
 
 /******************************************************************************/
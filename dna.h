@@ -10,10 +10,12 @@ Description:
 
 	The current version uses an enum type for the basic unit of dna, i.e. a
 nucleotide. Simple chars were discarded to provide flexibility to use the
-extended nucleotide alphabet (15-letter). The class provides conversion
-specifications between chars and nucleotides. It also defines which nucleotides
-match which, and with what "strength". The strength represents the probability
-that two nucleotides match. For example, the strength of a A-N match is 0.25.
+extended nucleotide alphabet (15-letter). Each nucleotide is a 4-bit mask of
+the bases it stands for (A, C, G and T are one bit each; e.g. R, A or G, is
+A|G, and N is all four bits). The class provides conversion specifications
+between chars and nucleotides. It also defines which nucleotides match which,
+and with what "strength". The strength represents the probability that two
+nucleotides match. For example, the strength of a A-N match is 0.25.
 
 	Class dna has three other static elements (on top of the character-
 -nucleotide specifications). One is a simple counter (counts the number of dna
@@ -25,10 +27,21 @@ the number of characters per line will be higher in Nice mode (but not in FASTA
 mode).
 
 	In addition to the static data members used described above, each dna
-object has three elements:
+object has the following elements:
 		- the name of the sequence (string)
-		- the nucleotide sequence (vector<nucleotide>)
+		- the packed nucleotide sequence (vector<unsigned char>)
+		- the sparse list of ambiguous nucleotides (see below)
+		- the packing of the sequence
 		- the length of the sequence (int)
+		- pointers to the packed sequence, the list of ambiguous
+	nucleotides and the name actually used (see 3.2 below)
+
+	There are two packings (see 3.1 below). In PACK4 each nucleotide is
+stored as its 4-bit mask, two per byte. In PACK2 the four bases are stored as
+2-bit codes, four per byte, and any other nucleotides (e.g. N) are kept in a
+separate list of (position, nucleotide) pairs sorted by position. The packing
+of new sequences is set with the static function packing(), and the default
+is PACK4.
 
 2. FUNCTIONS
 
@@ -47,13 +60,16 @@ the source file).
 
 	2.2. CONSTRUCTORS, DESTRUCTOR, AND ASSIGNMENT
 
-	A default constructor, a copy constructor, a destructor, and an assign-
-ment operator are defined for the class. Their use is intuitive. One important
-feature of the default constructor is that it checks whether a dna object has
-been previously initialized using the initialization flag. If no DNA objects
-have been initialized previously in the program execution, the information of
-nucleotide matching strengths must be hardcoded at this point. This is done by
-three private functions:
+	A default constructor, a copy constructor, a destructor, and an
+assignment operator are defined for the class. Their use is intuitive. The
+compilers this program is written for have no move constructors, so swap() is
+provided instead: it exchanges the contents of two objects without copying
+their sequences, e.g. to fill a vector without building each sequence twice.
+One important feature of the default constructor is that it checks whether a
+dna object has been previously initialized using the initialization flag. If no
+DNA objects have been initialized previously in the program execution, the
+information of nucleotide matching strengths must be hardcoded at this point.
+This is done by three private functions:
 		- valid_init(): sets the valid nucleotide characters to their
 	corresponding nucleotides. A non-valid character corresponds to X.
 		- match_init(): sets the nucleotide equivalences (e.g. S is
@@ -74,6 +90,17 @@ members. These functions are:
 		- n(): returns the number of objects currently in scope.
 		- operator[]: returns the nucleotide corresponding to the
 	specified position. Performs range checking.
+		- get(): the same as operator[], but without range checking,
+	for loops that already stay within the sequence.
+		- unpack(): writes the whole sequence into an array of
+	nucleotide codes (one byte each). This is much faster than repeated
+	calls to operator[], and is used by the alignment algorithms.
+		- bases(): whether every nucleotide of the sequence is one of
+	the four bases (A, C, G or T), which the alignment algorithms can score
+	with smaller integers (see dynamic.h). Immediate in PACK2.
+		- packing(): returns the packing used for new sequences.
+		- valid(): returns the nucleotide corresponding to a character
+	(X if the character is not valid). Lowercase is not converted.
 
 	2.4. "SET" FUNCTIONS
 
@@ -82,18 +109,39 @@ members. These functions are:
 	to that string.
 		- sequence(): Sets the nucleotide sequence from a string
 	argument. Invalid characters are discarded. Lowercase is automatically
-	converted to uppercase.
+	converted to uppercase. It can also be set from an array of nucleotide
+	codes (the inverse of unpack()), which is how the FASTA loader of
+	class fasta (see fasta.h) stores the sequences it reads.
 		- pmode(): Sets the printing mode to the specified value.
 		- wrap(): Sets the line wrap to the specified value.
+		- packing(): Sets the packing used for new sequences.
 
 3. NOTES
 
 	3.1. NUCLEOTIDES
 
-	The current nucleotide implementation is temporary and will be replaced
-by a 4-bit variable. The bitwise approach allows dynamic calculation of the
-nucleotide matching strengths, rather than the inelegant and error-prone hard-
-coding currently in use.
+	Nucleotides are 4-bit masks, which allows dynamic calculation of the
+nucleotide matching strengths: the strength of two nucleotides is the number of
+bases they have in common, divided by the product of their numbers of bases
+(i.e. the probability that the bases they stand for are the same). Two
+nucleotides match if their masks have a common bit.
+
+	Since a nucleotide fits in 4 bits, PACK4 uses one eighth of the memory
+of an array of enums, and PACK2 one sixteenth for sequences with few ambiguous
+nucleotides (which is the case of most ESTs). Random access is slower in PACK2
+if the sequence has ambiguous nucleotides, as the list must be searched.
+
+	3.2. VIEWS
+
+	The nucleotides are always read through the packed and ambiglist
+pointers, which normally point into the object's own vectors. A dna object can
+instead be a "view" of a sequence kept elsewhere, by class seqstore (see
+seqstore.h), which keeps all the sequences of a set in a single buffer and all
+the names in a single pool: the pointers then point into the store, and the
+object owns no memory. Copying a view copies the pointers, not the sequence.
+Setting the sequence of a view makes it an ordinary object again, and so does
+setting its name (for the name only). A view is only valid as long as its
+store is not modified or destroyed.
 
 	*/
 
@@ -104,14 +152,20 @@ coding currently in use.
 #include <iostream>
 #include <vector>
 #include <string>
+#include <utility>
+#include <algorithm>
 
 enum printmode { FASTA, NICE, RAW };
 
-enum nucleotide { A, C, G, T, R, Y, K, M, S, W, B, D, H, V, N, X };
+enum packmode { PACK4, PACK2 };
+
+enum nucleotide { X = 0, A = 1, C = 2, G = 4, T = 8,
+	R = A|G, Y = C|T, K = G|T, M = A|C, S = C|G, W = A|T,
+	B = C|G|T, D = A|G|T, H = A|C|T, V = A|C|G, N = A|C|G|T };
 
 const int DNAGRP = 10; // Length of group of characters when printing in "NICE"
 const int DNAALPHA = 15;	// Length of the nucleotide alphabet
-const int DNANAME = 100;	// the starting length for a name string
+const int DNACODES = 16;	// number of nucleotide codes (alphabet and X)
 const int DNASEQ = 100;		// the starting length for a sequence vector
 const int DNAWRAP = 60;		// the default line length for printing
 const int DNAASCII = 128;	// the number of ASCII characters
@@ -121,27 +175,37 @@ class dna
 		friend istream& operator>>( istream&, dna& );
 		friend ostream& operator<<( ostream&, const dna& );
 		friend double compare( const nucleotide&, const nucleotide& );
+		friend class seqstore;
 	public:
 		// constructors, destructor, and assignment operator
 		dna( void );
 		dna( const dna& );
 		~dna();
 		dna& operator=( const dna& );
+		void swap( dna& );
 
 		// "get" functions:
-		string name( void ) const { return name_; }
-		char letter( int i ) const { return nucprint_[ sequence_[i] ]; }
+		string name( void ) const
+			{ return nameptr_ ? string( nameptr_, namelen_ ) : name_; }
+		char letter( int i ) const { return nucprint_[ get(i) ]; }
 		int length( void ) const { return length_; }
 		static printmode pmode( void ) { return pmode_; }
 		static int wrap( void ) { return wrap_; }
 		static int n( void ) { return n_; }
+		static packmode packing( void ) { return packing_; }
+		static nucleotide valid( char );
 		nucleotide operator[]( int ) const;
+		nucleotide get( int ) const;
+		void unpack( unsigned char* ) const;
+		bool bases( void ) const;
 
 		// "set" functions:
-		void name( string n ) { name_ = n; }
+		void name( string n ) { name_ = n; nameptr_ = 0; }
 		void sequence( string s );
+		void sequence( const unsigned char*, int );
 		static void pmode( printmode pm ) { pmode_ = pm; }
 		static void wrap( int w ) { wrap_ = w; }
+		static void packing( packmode p ) { packing_ = p; }
 
 	private:
 		// copy and destroy functions for use by copy constructor,
@@ -153,11 +217,34 @@ class dna
 		void match_init( void );
 		void print_init( void );
 
+		// empty the sequence before setting it, and point the
+		// sequence pointers at the object's vectors
+		void reset( void );
+		void own( void );
+
+		// append a nucleotide to the packed sequence
+		void push( nucleotide );
+
+		// append n nucleotide codes to a packed sequence and its list
+		// of ambiguous nucleotides
+		static void pack( const unsigned char*, int, packmode,
+			vector<unsigned char>&, vector< pair<int, nucleotide> >& );
+
 	private:
 		string name_;			// the sequence name
-		vector<nucleotide> sequence_;	// the DNA sequence
+		vector<unsigned char> sequence_;// the packed DNA sequence
+		vector< pair<int, nucleotide> > ambig_;
+					// ambiguous nucleotides (PACK2 only)
+		packmode pack_;		// the packing of the sequence
 		int length_;			// the sequence length
 
+		const unsigned char* packed_;	// the packed sequence used,
+		const pair<int, nucleotide>* ambiglist_;// its ambiguous
+		int ambigs_;			// nucleotides and their number
+		bool view_;		// are they kept by a seqstore?
+		const char* nameptr_;	// the name in a seqstore, if not 0,
+		int namelen_;		// and its length
+
 		static vector<nucleotide> valid_;
 					// valid nucleotide characters
 		static vector< vector<double> > matching_;
@@ -168,9 +255,43 @@ class dna
 		static printmode pmode_;// the printing mode (fasta, nice, ...)
 		static int wrap_;	// the line wrap length for printing
 		static int n_;		// the number of dna objects initialized
+		static packmode packing_;
+					// the packing of new sequences
+		static const nucleotide bases_[4];
+					// the nucleotides of the PACK2 codes
 
 		static bool init_;	// whether a dna object has been
 					// initialized during program execution
 };
 
+// declaration of compare() outside of the class, for compilers that do not
+// make friend functions visible outside of it
+double compare( const nucleotide&, const nucleotide& );
+
+/******************************************************************************/
+
+// return the nucleotide at position i (no range checking)
+
+inline nucleotide dna::get( int i ) const
+{
+	if( pack_ == PACK4 )
+	{
+		return static_cast<nucleotide>
+			( ( packed_[i >> 1] >> ( ( i & 1 ) << 2 ) ) & 0xf );
+	}
+
+	// in PACK2, look for the position in the list of ambiguous
+	// nucleotides first
+	if( ambigs_ > 0 )
+	{
+		const pair<int, nucleotide>* pos = lower_bound( ambiglist_,
+			ambiglist_ + ambigs_, pair<int, nucleotide>( i, X ) );
+		if( pos != ambiglist_ + ambigs_ && pos->first == i )
+		{
+			return pos->second;
+		}
+	}
+	return bases_[ ( packed_[i >> 2] >> ( ( i & 3 ) << 1 ) ) & 3 ];
+}
+
 #endif
@@ -13,6 +13,9 @@ Description:	The dynamic programming algorithm is O(n*m) and implemented in
 		printing is necessary the function tracepath() can be called.
 		Note that printing is safe, i.e. operator<< will call
 		tracepath() if it hasn't been done manually.
+		In DYNSCORE mode align() calls alignscore(), which only
+		keeps two columns of each matrix in memory, or uses the
+		vectorized kernel of class striped where possible.
 		For further details on individual functions see the function
 		definition.
 	*/
@@ -20,9 +23,12 @@ Description:	The dynamic programming algorithm is O(n*m) and implemented in
 
 #include "dna.h"
 #include "dynamic.h"
+#include "striped.h"
 #include <vector>
 #include <iostream>
 #include <cstdlib>
+#include <cmath>
+#include <algorithm>
 
 /******************************************************************************/
 
@@ -117,7 +123,8 @@ ostream& operator<<( ostream& output, dynamic& d1 )
 //	provided solely for unavoidable circumstances, such as when an array
 //	of 'dynamic' objects is needed
 
-dynamic::dynamic( float m, float mm, float go, float gx, int sl )
+dynamic::dynamic( float m, float mm, float go, float gx, int sl, dynmode md,
+	float xd, int bw, int dg )
 	:
 	// initialize dna pointers to 0
 	dna1ptr_( 0 ), dna2ptr_( 0 ),
@@ -131,6 +138,9 @@ dynamic::dynamic( float m, float mm, float go, float gx, int sl )
 	// initialize matrices to 0
 	scrMatrix_( 0 ), ptrMatrix_( 0 ),
 
+	// set the alignment mode
+	mode_( md ), full_( false ), ptrcol_( 0 ),
+
 	// initialize all coordinates to 0
 	xbegin_( 0 ), ybegin_( 0 ),
 	xend_( 0 ), yend_( 0 ),
@@ -138,18 +148,26 @@ dynamic::dynamic( float m, float mm, float go, float gx, int sl )
 	// initialize path length to 0
 	pathlength_( 0 ),
 
+	// nothing aligned yet
+	cells_( 0 ), stopped_( 0 ), abandoned_( 0 ),
+
 	// initialize printing wrap value ( aka linelength )
 	wrap_( DYNWRAP ),
 
 	// initialize penalties and rewards for alignment
 	match_( m ), msmatch_( mm ), gapopen_( go ), gapxtnd_( gx ),
 
+	// set the band and the X-drop value
+	bandwidth_( bw ), diagonal_( dg ), xdrop_( xd ),
+
 	// set the aligned flag to false
 	aligned_( false ),
 
 	// set the significance level
 	significance_( sl )
 {
+	// build the substitution tables
+	scoring();
 }
 	
 /******************************************************************************/
@@ -157,7 +175,8 @@ dynamic::dynamic( float m, float mm, float go, float gx, int sl )
 // initializing constructor for class dynamic
 
 dynamic::dynamic( dna& d1, dna& d2, bool s, int sl,
-	float m, float mm, float go, float gx )
+	float m, float mm, float go, float gx, dynmode md, float xd, int bw,
+	int dg )
 	:
 	// initialize dna elements
 	dna1ptr_( &d1 ), dna2ptr_( &d2 ),
@@ -168,8 +187,16 @@ dynamic::dynamic( dna& d1, dna& d2, bool s, int sl,
 	// initialize x and y lengths for matrices
 	xlen_( dna1ptr_->length() ), ylen_( dna2ptr_->length() ),
 
-	// initialize matrices to appropriate sizes
-	scrMatrix_( xlen_, ylen_ ), ptrMatrix_( xlen_, ylen_ ),
+	// initialize matrices to appropriate sizes (none in DYNSCORE mode, or
+	// if they would be too large)
+	scrMatrix_( ( md == DYNFULL && fits( xlen_, ylen_ ) ) ? xlen_ * ylen_
+		: 0 ),
+	ptrMatrix_( ( md == DYNFULL && fits( xlen_, ylen_ ) ) ? xlen_ * ylen_
+		: 0 ),
+
+	// set the alignment mode
+	mode_( md ), full_( md == DYNFULL && fits( xlen_, ylen_ ) ),
+	ptrcol_( 0 ),
 
 	// initialize all other coordinates to 0
 	xbegin_( 0 ), ybegin_( 0 ), xend_( 0 ), yend_( 0 ),
@@ -177,15 +204,27 @@ dynamic::dynamic( dna& d1, dna& d2, bool s, int sl,
 	// initialize path length to 0
 	pathlength_( 0 ),
 
+	// nothing aligned yet
+	cells_( 0 ), stopped_( 0 ), abandoned_( 0 ),
+
 	// initialize printing wrap value ( aka linelength )
 	wrap_( DYNWRAP ),
 
 	// initialize penalties and rewards for alignment
 	match_( m ), msmatch_( mm ), gapopen_( go ), gapxtnd_( gx ),
 
+	// set the band and the X-drop value
+	bandwidth_( bw ), diagonal_( dg ), xdrop_( xd ),
+
+	// set the aligned flag to false
+	aligned_( false ),
+
 	// set the significance level
 	significance_( sl )
 {
+	// build the substitution tables
+	scoring();
+
 	// align the sequences
 	align( s );
 }
@@ -205,7 +244,9 @@ dynamic::dynamic( const dynamic& d1 )
 
 dynamic& dynamic::operator=( const dynamic& d1 )
 {
-	if( *this == d1 ) // avoid self-assignment
+	// avoid self-assignment (operator== compares the scores, so two
+	// different objects can be equal)
+	if( this == &d1 )
 	{
 		return *this;
 	}
@@ -213,6 +254,66 @@ dynamic& dynamic::operator=( const dynamic& d1 )
 	copy( d1 );
 	return *this;
 }
+
+/******************************************************************************/
+
+// exchange two values of a member
+
+template <class T> static inline void exchange( T& a, T& b )
+{
+	T t( a );
+	a = b;
+	b = t;
+}
+
+// exchange the contents of two dynamic objects without copying their matrices
+//	(the vectors exchange their buffers). The kernels stay with their
+//	objects, and are given the exchanged scores by scoring().
+
+void dynamic::swap( dynamic& d1 )
+{
+	exchange( dna1ptr_, d1.dna1ptr_ );
+	exchange( dna2ptr_, d1.dna2ptr_ );
+	exchange( score_, d1.score_ );
+	exchange( xlen_, d1.xlen_ );
+	exchange( ylen_, d1.ylen_ );
+	scrMatrix_.swap( d1.scrMatrix_ );
+	ptrMatrix_.swap( d1.ptrMatrix_ );
+	hScr_.swap( d1.hScr_ );
+	fScr_.swap( d1.fScr_ );
+	xcodes_.swap( d1.xcodes_ );
+	ycodes_.swap( d1.ycodes_ );
+	exchange( mode_, d1.mode_ );
+	exchange( full_, d1.full_ );
+	exchange( ptrcol_, d1.ptrcol_ );
+	exchange( xbegin_, d1.xbegin_ );
+	exchange( ybegin_, d1.ybegin_ );
+	exchange( xend_, d1.xend_ );
+	exchange( yend_, d1.yend_ );
+	exchange( pathlength_, d1.pathlength_ );
+	exchange( cells_, d1.cells_ );
+	exchange( stopped_, d1.stopped_ );
+	exchange( abandoned_, d1.abandoned_ );
+	top_.swap( d1.top_ );
+	bottom_.swap( d1.bottom_ );
+	align_.swap( d1.align_ );
+	exchange( wrap_, d1.wrap_ );
+	exchange( match_, d1.match_ );
+	exchange( msmatch_, d1.msmatch_ );
+	exchange( gapopen_, d1.gapopen_ );
+	exchange( gapxtnd_, d1.gapxtnd_ );
+	exchange( bandwidth_, d1.bandwidth_ );
+	exchange( diagonal_, d1.diagonal_ );
+	exchange( xdrop_, d1.xdrop_ );
+	exchange( significance_, d1.significance_ );
+
+	// scoring() clears the aligned flags, so they are exchanged after it
+	bool aligned = aligned_, aligned1 = d1.aligned_;
+	scoring();
+	d1.scoring();
+	aligned_ = aligned1;
+	d1.aligned_ = aligned;
+}
 /******************************************************************************/
 
 // destructor for class dynamic
@@ -236,20 +337,25 @@ void dynamic::input( dna& d1, dna& d2, bool s )
 	xlen_ = d1.length();
 	ylen_ = d2.length();
 
-	// make sure any previous matrices are properly deleted
-	destroy();
-
-	// initialize score and pointer matrices
-
-	// initialize first dimension
-	scrMatrix_.resize( xlen_ );
-	ptrMatrix_.resize( xlen_ );
-
-	// initialize second dimension
-	for( int i = 0; i < xlen_; i++ )
+	// reset the results of any previous alignment
+	score_ = 0;
+	xbegin_ = ybegin_ = xend_ = yend_ = 0;
+	pathlength_ = 0;
+	cells_ = 0;
+	stopped_ = abandoned_ = 0;
+	aligned_ = false;
+
+	// size the score and pointer matrices (only two columns are needed
+	// in DYNSCORE mode, and these are sized by alignscore(), and
+	// tracepath() does without them if they would be too large). The
+	// matrices are not deleted first: resize() keeps the memory of the
+	// previous alignment, so an object reused as a workspace only
+	// allocates when a larger pair of sequences comes along.
+	full_ = ( mode_ == DYNFULL && fits( xlen_, ylen_ ) );
+	if( full_ )
 	{
-		scrMatrix_[i].resize( ylen_ );
-		ptrMatrix_[i].resize( ylen_ );
+		scrMatrix_.resize( xlen_ * ylen_ );
+		ptrMatrix_.resize( xlen_ * ylen_ );
 	}
 
 	// align the sequences
@@ -258,22 +364,254 @@ void dynamic::input( dna& d1, dna& d2, bool s )
 
 /******************************************************************************/
 
-// align the two dna sequences using the dynamic programming algorithm
-//	NOTE: The pointer matrix is implemented as a matrix of ints. This allows
-//	selection of array values using the pointers directly, and is also
-//	easier to debug. The symbolic constants for NULL, UP, DIAG, and LEFT are
-//	defined in the header file.
+// align the two dna sequences using the dynamic programming algorithm. In
+//	DYNFULL mode this is gotoh(), which also fills in the matrices; in
+//	DYNSCORE mode alignscore() tries the vectorized kernel first.
 
 void dynamic::align( bool s )
 {
-	// dna refs to avoid pointer notation
-	dna& dna1( *dna1ptr_ ), & dna2( *dna2ptr_ );
+	// the score-only alignment does not need the matrices
+	if( mode_ == DYNSCORE )
+	{
+		alignscore( s );
+		return;
+	}
+
+	gotoh( s );
+}
+
+/******************************************************************************/
+
+// score-only version of align(). If possible the vectorized kernel is used,
+//	and otherwise gotoh(), which only keeps the columns. The end coordinates
+//	of the alignment are still recorded, but the path cannot be traced from
+//	them. The vectorized kernel supports the X-drop mode, but not the band.
+
+void dynamic::alignscore( bool s )
+{
+	// nothing to align if either of the sequences is empty
+	if( xlen_ < 1 || ylen_ < 1 )
+	{
+		aligned_ = true;
+		return;
+	}
+
+	// use the vectorized kernel if the scores can be represented as
+	// integers, scored in the units of the bases if the pair is made of
+	// bases only (see dynamic.h, 3.7). The kernel reports failure if its
+	// scores overflow, in which case the scalar alignment is performed.
+	// It only leaves columns out if it stopped at significance or
+	// abandoned the alignment.
+	if( striped::available() && exact_ && bandwidth_ < 0 )
+	{
+		bool bases = narrow( *dna1ptr_, *dna2ptr_ );
+		striped& kernel = bases ? bkernel_ : kernel_;
+		int ratio = bases ? scale_ / bscale_ : 1;
+		kernel.query( *dna1ptr_ );
+
+		int stop, reject, slack;
+		limits( s, stop, reject, slack, ratio );
+		if( kernel.align( *dna2ptr_, stop, reject, slack ) )
+		{
+			score_ = static_cast<float>( kernel.score() * ratio )
+				/ scale_;
+			xend_ = kernel.xend();
+			yend_ = kernel.yend();
+			cells_ = static_cast<double>( kernel.columns() ) * xlen_;
+			if( kernel.columns() < ylen_ && kernel.score() >= stop )
+			{
+				stopped_ = 1;
+			}
+			else if( kernel.columns() < ylen_ )
+			{
+				abandoned_ = 1;
+			}
+			aligned_ = true;
+			return;
+		}
+	}
+
+	gotoh( s );
+}
+
+/******************************************************************************/
+
+// the significance threshold in the integer units of the kernel, and the
+//	X-drop parameters: the alignment is rejected when it can no longer
+//	reach the threshold. In units ratio times larger (see dynamic.h, 3.7)
+//	a score reaches stop if ratio times it does, and the kernel rejects an
+//	alignment when its bound is below reject + slack, so both are rounded
+//	up (slack as part of the sum).
+
+void dynamic::limits( bool s, int& stop, int& reject, int& slack,
+	int ratio ) const
+{
+	stop = s ? static_cast<int>( ceil( threshold() * scale_ - 1e-3 ) ) : 0;
+	reject = ( s && xdrop_ >= 0 ) ? stop : 0;
+	slack = ( xdrop_ > 0 ) ? static_cast<int>( floor( xdrop_ * scale_ ) )
+		: 0;
+
+	if( ratio > 1 )
+	{
+		int bound = ( reject + slack + ratio - 1 ) / ratio;
+		stop = ( stop + ratio - 1 ) / ratio;
+		reject = ( reject + ratio - 1 ) / ratio;
+		slack = ( reject > 0 ) ? bound - reject : 0;
+	}
+}
+
+/******************************************************************************/
+
+// align the x-sequence against many y-sequences with the batch kernel (see
+//	dynamic.h, 3.6), which leaves short lists and the pairs it can not align
+//	to input().
+//	Their scores are returned in order, and the cells and counts of all the
+//	alignments are added up.
+
+void dynamic::batch( dna& x, const vector<dna*>& ys, vector<float>& scores,
+	bool s )
+{
+	int n = static_cast<int>( ys.size() );
+	vector<int> iscores( n, -1 );
+	double cells = 0;
+	int stopped = 0, abandoned = 0;
+
+	if( mode_ == DYNSCORE && striped::available() && exact_
+		&& bandwidth_ < 0 && n >= DYNBATCH )
+	{
+		// the targets made of bases, if x is too, are given to the
+		// kernel of the bases (see dynamic.h, 3.7), and the others to
+		// the kernel of the full scale
+		vector<dna*> targets[2];
+		vector<int> which[2];
+		bool bases = bscale_ > 0 && x.bases();
+		int k;
+		for( k = 0; k < n; k++ )
+		{
+			int b = ( bases && ys[k]->bases() ) ? 1 : 0;
+			targets[b].push_back( ys[k] );
+			which[b].push_back( k );
+		}
+
+		vector<int> part, columns;
+		for( int b = 0; b < 2; b++ )
+		{
+			if( targets[b].empty() )
+			{
+				continue;
+			}
+			striped& kernel = b ? bkernel_ : kernel_;
+			int ratio = b ? scale_ / bscale_ : 1;
+			int stop, reject, slack;
+			limits( s, stop, reject, slack, ratio );
+			kernel.query( x );
+			kernel.align( targets[b], part, columns, stop, reject,
+				slack );
+			for( k = 0; k < static_cast<int>( part.size() ); k++ )
+			{
+				if( part[k] < 0 )
+				{
+					continue;
+				}
+				iscores[ which[b][k] ] = part[k] * ratio;
+				cells += static_cast<double>( columns[k] )
+					* x.length();
+				if( columns[k] < targets[b][k]->length() )
+				{
+					if( part[k] >= stop )
+					{
+						stopped++;
+					}
+					else
+					{
+						abandoned++;
+					}
+				}
+			}
+		}
+	}
+
+	scores.resize( n );
+	for( int k = 0; k < n; k++ )
+	{
+		if( iscores[k] >= 0 )
+		{
+			scores[k] = static_cast<float>( iscores[k] ) / scale_;
+		}
+		else
+		{
+			input( x, *ys[k], s );
+			scores[k] = score_;
+			cells += cells_;
+			stopped += stopped_;
+			abandoned += abandoned_;
+		}
+	}
+	cells_ = cells;
+	stopped_ = stopped;
+	abandoned_ = abandoned;
+	aligned_ = false;
+}
+
+/******************************************************************************/
+
+// the three-state recurrence (see dynamic.h, 3.1). Column j of H and F
+//	overwrites column j-1 in hScr_ and fScr_ as it is computed: hdiag keeps
+//	H(i-1,j-1) once it has been overwritten, and hleft and e hold H and E of
+//	the previous cell of the column. In DYNFULL mode the scores and pointers
+//	are also stored in the matrices, unless they would be too large (see
+//	dynamic.h, 3.5).
+//	NOTE: The pointer matrix is implemented as a matrix of chars holding the
+//	int pointer values, so they can be used to select array values
+//	directly. The symbolic constants for NULL, UP, DIAG, LEFT and the gap
+//	flags are defined in the header file.
+//	In banded mode only the rows bandlo(j) to bandhi(j) of column j are
+//	computed. Cells outside the band are taken to be 0: the first row of the
+//	band starts with hleft = e = 0, and the row just below the band is reset
+//	to 0, since the band of the next column reads it. The other cells are
+//	never read, by the loop or by tracepath().
+
+void dynamic::gotoh( bool s )
+{
+	// the sequences are unpacked once, rather than decoding the packed
+	// nucleotides in the inner loop
+	unpack();
+
+	// the column before the first one is outside the matrix (no
+	// reallocation if the object is reused for sequences of similar
+	// lengths)
+	hScr_.assign( xlen_, 0 );
+	fScr_.assign( xlen_, 0 );
+
+	// calculate the local alignment score of each cell in the matrix,
+	// updating the pointers along the way if the matrices are kept
+	ptrcol_ = 0;
+	cells_ = sweep( 0, ylen_, s, full_, full_ );
+
+	// set the aligned flag to true
+	aligned_ = true;
+}
+
+/******************************************************************************/
+
+// compute the columns jfrom to jto-1 of the recurrence, from column jfrom-1 in
+//	hScr_ and fScr_ (see gotoh()), keeping the scores and the pointers of
+//	the cells in the matrices if asked to. Returns early if the alignment
+//	stops at significance, or is abandoned in X-drop mode, which is then
+//	counted if cells were left. Returns the number of cells computed.
+
+double dynamic::sweep( int jfrom, int jto, bool s, bool scores,
+	bool pointers )
+{
+	double cells = 0;
+
+	const unsigned char* dna1( &xcodes_[0] ), * dna2( &ycodes_[0] );
 
 	// declare index ints for general use
 	register int i, j;
 
-	double res = 0.0; // cache variable stores nucleotide comparison
-			     // results
+	const float* subst;	// the substitution scores of the nucleotide
+				// of the current column (see scoring())
 
 	float allscores[4];	// an array containing the possible scores for
 				// any given cell in the score matrix (only the
@@ -282,65 +620,73 @@ void dynamic::align( bool s )
 	allscores[PTRNULL] = 0;	// since this is a local alignment, 0 is always
 				// a choice for a cell
 
-	// initialize first row of scores and pointers
-	for( i = 0; i < xlen_; i++ )
+	for( j = jfrom; j < jto; j++ )
 	{
-		// the score of the cell will be a match if the nucleotides
-		// match, 0 otherwise
-		scrMatrix_[i][0] = ( res = compare( dna1[i], dna2[0] ) )?
-					res * match_ : 0;
+		subst = &fsubst_[ dna2[j] * DNACODES ];
 
-		// the pointers will always be NULL
-		ptrMatrix_[i][0] = PTRNULL;
-	}
+		// the rows of the column inside the band (all of them if
+		// the alignment is not banded). Once the band has left the
+		// matrix no cell is left to compute
+		int lo = bandlo( j ), hi = bandhi( j );
+		if( lo >= xlen_ )
+		{
+			break;
+		}
 
-	// initialize first column of scores and pointers
-	for( j = 1; j < ylen_; j++ )
-	{
-		// [ as above ]
-		scrMatrix_[0][j] = ( res = compare( dna1[0], dna2[j] ) )?
-					res * match_ : 0;
-		ptrMatrix_[0][j] = PTRNULL;
-	}
+		cells += ( hi >= lo ) ? hi - lo + 1 : 0;
+		float hdiag = ( lo > 0 ) ? hScr_[lo-1] : 0;
+		float hleft = 0, e = 0;
+		float colmax = 0;	// the best cell of the column
 
-	// calculate the local alignment score of each cell in the matrix,
-	// updating the pointers along the way.
-	for( j = 1; j < ylen_; j++ )
-	{
-		for( i = 1; i < xlen_; i++ )
+		for( i = lo; i <= hi; i++ )
 		{
-			// the score coming from the LEFT will be the score
-			// from the LEFT adjacent cell, plus a gap opening
-			// penalty if a new gap is being formed, or a gap
-			// extension penalty otherwise
-			allscores[PTRLEFT] = scrMatrix_[i-1][j] +
-					( ( ptrMatrix_[i-1][j] == PTRLEFT ) ?
-					gapxtnd_ : gapopen_ );
+			float hup = hScr_[i];
+
+			// the gap coming from the LEFT either opens after the
+			// LEFT adjacent cell, or extends its gap
+			float open = hleft + gapopen_, xtnd = e + gapxtnd_;
+			bool xleft = ( xtnd > open );
+			e = xleft ? xtnd : open;
 
 			// [ as above, replace LEFT with UP ]
-			allscores[PTRUP] = scrMatrix_[i][j-1] +
-					( ( ptrMatrix_[i][j-1] == PTRUP ) ?
-					gapxtnd_ : gapopen_ );
+			open = hup + gapopen_;
+			xtnd = fScr_[i] + gapxtnd_;
+			bool xup = ( xtnd > open );
+			fScr_[i] = xup ? xtnd : open;
 
 			// the score coming from the diagonal will be the score
 			// from the diagonally adjacent cell plus a match if
 			// the nucleotides match, a mismatch otherwise
-			allscores[PTRDIAG] = scrMatrix_[i-1][j-1] + (
-					( res = compare( dna1[i], dna2[j] ) ) ?
-					( res * match_ ) : msmatch_ );
-
-			// the pointer indicates the origin of the highest of
-			// the four scores
-			ptrMatrix_[i][j] = max( allscores, 4 );
+			allscores[PTRLEFT] = e;
+			allscores[PTRUP] = fScr_[i];
+			allscores[PTRDIAG] = hdiag + subst[ dna1[i] ];
+
+			// the score will be the highest of the four scores,
+			// and the pointer indicates its origin
+			int move = max( allscores, 4 );
+			float h = allscores[move];
+
+			hdiag = hup;
+			hleft = hScr_[i] = h;
+			if( scores )
+			{
+				scr( i, j ) = h;
+			}
+			if( pointers )
+			{
+				ptr( i, j ) = move | ( xleft ? PTRLEFTX : 0 )
+					| ( xup ? PTRUPX : 0 );
+			}
 
-			// the score will be the highest of the four scores, as
-			// indicated by the pointer
-			scrMatrix_[i][j] = allscores[ ptrMatrix_[i][j] ];
+			if( h > colmax )
+			{
+				colmax = h;
+			}
 
 			// substitute the maximum score if it has been surpassed
-			if( scrMatrix_[i][j] > score_ )
+			if( h > score_ )
 			{
-				score_ = scrMatrix_[i][j];
+				score_ = h;
 				xend_ = i;
 				yend_ = j;
 
@@ -348,18 +694,29 @@ void dynamic::align( bool s )
 				// alignment is significant, (that's what s
 				// is for... See header documentation), and
 				// we have reached significance, exit.
-				if( s && significant() )
+				if( s && reached() )
 				{
-					return;
+					stopped_ = ( i < hi || j < jto - 1 ) ? 1 : 0;
+					return cells - ( hi - i );
 				}
 			}
 		}
-	}
 
-	// set the aligned flag to true
-	aligned_ = true;
+		// the row below the band enters the band in the next column
+		if( hi >= -1 && hi+1 < xlen_ )
+		{
+			hScr_[hi+1] = 0;
+			fScr_[hi+1] = 0;
+		}
 
-	return;
+		// in X-drop mode, give up once significance is out of reach
+		if( s && xdrop_ >= 0 && hopeless( colmax, j ) )
+		{
+			abandoned_ = ( j < jto - 1 ) ? 1 : 0;
+			return cells;
+		}
+	}
+	return cells;
 }
 
 /******************************************************************************/
@@ -370,68 +727,204 @@ void dynamic::align( bool s )
 void dynamic::copy( const dynamic& d1 )
 {
 	// copy elements that must be initialized
+	mode_ = d1.mode_;
 	pathlength_ = d1.pathlength_;
 	wrap_ = d1.wrap_;
 	match_ = d1.match_;
 	msmatch_ = d1.msmatch_;
 	gapopen_ = d1.gapopen_;
 	gapxtnd_ = d1.gapxtnd_;
+	significance_ = d1.significance_;
+	bandwidth_ = d1.bandwidth_;
+	diagonal_ = d1.diagonal_;
+	xdrop_ = d1.xdrop_;
+	dna1ptr_ = d1.dna1ptr_;
+	dna2ptr_ = d1.dna2ptr_;
+	score_ = d1.score_;
+	xlen_ = d1.xlen_;
+	ylen_ = d1.ylen_;
+	xbegin_ = d1.xbegin_;
+	ybegin_ = d1.ybegin_;
+	xend_ = d1.xend_;
+	yend_ = d1.yend_;
+	cells_ = d1.cells_;
+	stopped_ = d1.stopped_;
+	abandoned_ = d1.abandoned_;
+
+	// rebuild the substitution tables before taking the aligned flag,
+	// which scoring() clears
+	scoring();
+	aligned_ = d1.aligned_;
+
+	// copy the matrices only if they hold an alignment (they are empty
+	// in DYNSCORE mode): a prototype object, such as the one copied by
+	// each thread of allpairs (see allpairs.h), copies no memory. The
+	// workspace columns are never copied
+	full_ = ( d1.aligned_ && d1.full_ );
+	ptrcol_ = 0;
+	if( full_ )
+	{
+		scrMatrix_ = d1.scrMatrix_;
+		ptrMatrix_ = d1.ptrMatrix_;
+	}
 
-	// copy elements that will be present if sequences have been aligned
-	if( d1.aligned_ )
+	// check whether the path has been traced, and if so copy the
+	// alignment strings
+	if( d1.aligned_ && pathlength_ )
 	{
-		aligned_ = d1.aligned_;
-		significance_ = d1.significance_;
+		top_ = d1.top_;
+		bottom_ = d1.bottom_;
+		align_ = d1.align_;
+	}
+}
+
+/******************************************************************************/
+
+// deletes dynamically allocated elements (used by assignment operator and by
+//	class destructor).
 
-		dna1ptr_ = d1.dna1ptr_;
-		dna2ptr_ = d1.dna2ptr_;
-		score_ = d1.score_;
-		xlen_ = d1.xlen_;
-		ylen_ = d1.ylen_;
+void dynamic::destroy( void )
+{
+	scrMatrix_.clear();
+	ptrMatrix_.clear();
+}
 
-		// create space for dynamically allocated elements
+/******************************************************************************/
 
-		scrMatrix_.resize( xlen_ );
-		ptrMatrix_.resize( xlen_ );
+// build the substitution tables from the rewards and penalties. Called
+//	whenever they change. Cell (a,b) of each table is the score of aligning
+//	nucleotide codes a and b: the match strength times the match reward, or
+//	the mismatch penalty if they do not match. X (an invalid nucleotide,
+//	never stored in a sequence) matches nothing.
+//	The float table is used by align() and alignscore(). The integer table
+//	holds the same scores times scale_, the smallest factor (up to
+//	DYNSCALE) that makes all the scores and gap penalties integral. If
+//	there is no such factor, exact_ is false and the vectorized kernel can
+//	not be used. The kernel of the bases gets their scores times bscale_.
+
+void dynamic::scoring( void )
+{
+	int a, b;
 
-		for( int i = 0; i < xlen_; i++ )
+	for( a = 0; a < DNACODES; a++ )
+	{
+		for( b = 0; b < DNACODES; b++ )
 		{
-			scrMatrix_[i].resize( ylen_ );
-			ptrMatrix_[i].resize( ylen_ );
-	
-			// copy dynamically alocated elements
+			double res = compare( static_cast<nucleotide>( a ),
+				static_cast<nucleotide>( b ) );
+			fsubst_[ a * DNACODES + b ] = res ? res * match_ :
+				msmatch_;
+		}
+	}
 
-			for( int j = 0; j < ylen_; j++ )
+	maxsubst_ = fsubst_[0];
+	for( a = 1; a < DNACODES * DNACODES; a++ )
+	{
+		if( fsubst_[a] > maxsubst_ )
+		{
+			maxsubst_ = fsubst_[a];
+		}
+	}
+
+	// find the scale. A value is considered integral if it is within
+	// 0.001 of an integer, to allow for the representation error of the
+	// floats (e.g. 0.2)
+	exact_ = false;
+	for( scale_ = 1; scale_ <= DYNSCALE; scale_++ )
+	{
+		exact_ = integral( gapopen_ * scale_ ) &&
+			integral( gapxtnd_ * scale_ );
+		for( a = 0; a < DNACODES * DNACODES && exact_; a++ )
+		{
+			exact_ = integral( fsubst_[a] * scale_ );
+		}
+		if( exact_ )
+		{
+			break;
+		}
+	}
+
+	if( exact_ )
+	{
+		for( a = 0; a < DNACODES * DNACODES; a++ )
+		{
+			isubst_[a] = static_cast<int>
+				( floor( fsubst_[a] * scale_ + 0.5 ) );
+		}
+		exact_ = kernel_.scoring( isubst_,
+			static_cast<int>( floor( gapopen_ * scale_ + 0.5 ) ),
+			static_cast<int>( floor( gapxtnd_ * scale_ + 0.5 ) ) );
+	}
+	else
+	{
+		scale_ = 1;
+	}
+
+	// the smallest divisor of the scale that makes the scores of the
+	// bases integral, if it is smaller (see dynamic.h, 3.7). The other
+	// codes are never aligned with it: they get the mismatch penalty.
+	bscale_ = 0;
+	for( int bs = 1; bs < scale_ && exact_; bs++ )
+	{
+		int ratio = scale_ / bs;
+		int go = static_cast<int>( floor( gapopen_ * bs + 0.5 ) );
+		int gx = static_cast<int>( floor( gapxtnd_ * bs + 0.5 ) );
+		bool fits = ( scale_ % bs == 0 )
+			&& integral( gapopen_ * bs ) && integral( gapxtnd_ * bs )
+			&& go * ratio == static_cast<int>
+				( floor( gapopen_ * scale_ + 0.5 ) )
+			&& gx * ratio == static_cast<int>
+				( floor( gapxtnd_ * scale_ + 0.5 ) );
+		int bsubst[DNACODES * DNACODES];
+		for( a = 0; a < DNACODES * DNACODES; a++ )
+		{
+			bsubst[a] = static_cast<int>( floor( msmatch_ * bs + 0.5 ) );
+		}
+		for( a = A; a <= T && fits; a <<= 1 )
+		{
+			for( b = A; b <= T && fits; b <<= 1 )
 			{
-				scrMatrix_[i][j] = d1.scrMatrix_[i][j];
-				ptrMatrix_[i][j] = d1.ptrMatrix_[i][j];
+				int c = a * DNACODES + b;
+				bsubst[c] = static_cast<int>
+					( floor( fsubst_[c] * bs + 0.5 ) );
+				fits = integral( fsubst_[c] * bs )
+					&& bsubst[c] * ratio == isubst_[c];
 			}
 		}
-		// check whether the path has been traced, and if so copy
-		// 	appropriate elements
-		if( pathlength_ )
+		if( fits )
 		{
-			xbegin_ = d1.xbegin_;
-			ybegin_ = d1.ybegin_;
-			xend_ = d1.xend_;
-			yend_ = d1.yend_;
-
-			top_ = d1.top_;
-			bottom_ = d1.bottom_;
-			align_ = d1.align_;
+			if( bkernel_.scoring( bsubst, go, gx ) )
+			{
+				bscale_ = bs;
+			}
+			break;
 		}
 	}
+
+	aligned_ = false;
 }
 
 /******************************************************************************/
 
-// deletes dynamically allocated elements (used by assignment operator and by
-//	class destructor).
+// is a value integral (within 0.001)?
 
-void dynamic::destroy( void )
+bool dynamic::integral( double v )
 {
-	scrMatrix_.clear();
-	ptrMatrix_.clear();
+	return ( fabs( v - floor( v + 0.5 ) ) < 1e-3 );
+}
+
+/******************************************************************************/
+
+// unpack the nucleotide codes of both sequences into xcodes_ and ycodes_. The
+//	buffers are kept between alignments, and always hold at least one
+//	element so that they can be addressed even for empty sequences.
+
+void dynamic::unpack( void )
+{
+	xcodes_.resize( xlen_ > 0 ? xlen_ : 1 );
+	ycodes_.resize( ylen_ > 0 ? ylen_ : 1 );
+	dna1ptr_->unpack( &xcodes_[0] );
+	dna2ptr_->unpack( &ycodes_[0] );
 }
 
 /******************************************************************************/
@@ -445,126 +938,315 @@ bool dynamic::significant( void )
 	{
 		return false;
 	}
-	if( score_ < (significance_ * (match_ + 0.05 * msmatch_)) )
+	return reached();
+}
+
+/******************************************************************************/
+
+// the integer scores of the kernel: the substitution table (DNACODES x
+//	DNACODES), the gap open and extension penalties (positive), and the
+//	significance threshold. Returns false if the scores are not integral.
+
+bool dynamic::integral( int* subst, int& go, int& gx, int& stop ) const
+{
+	if( !exact_ )
 	{
 		return false;
 	}
+	for( int a = 0; a < DNACODES * DNACODES; a++ )
+	{
+		subst[a] = isubst_[a];
+	}
+	go = -static_cast<int>( floor( gapopen_ * scale_ + 0.5 ) );
+	gx = -static_cast<int>( floor( gapxtnd_ * scale_ + 0.5 ) );
+
+	int reject, slack;
+	limits( true, stop, reject, slack );
 	return true;
 }
 
 /******************************************************************************/
 
+// does a score reach the significance threshold? Unlike significant(), this
+//	does not require an alignment, so align() can stop early. With integral
+//	scores it decides in the units of the kernel (see dynamic.h, 3.3), with
+//	the threshold that limits() gives it.
+
+bool dynamic::reaches( double sc ) const
+{
+	if( exact_ )
+	{
+		return ( floor( sc * scale_ + 0.5 )
+			>= ceil( threshold() * scale_ - 1e-3 ) );
+	}
+	return ( sc >= threshold() - 1e-3 );
+}
+
+/******************************************************************************/
+
+// the score needed for significance
+
+double dynamic::threshold( void ) const
+{
+	return significance_ * (match_ + 0.05 * msmatch_);
+}
+
+/******************************************************************************/
+
+// can the significance threshold no longer be reached once column j, whose best
+//	cell scores colmax, has been computed? Any later alignment either goes
+//	through a cell of the column or starts after it, and gains at most
+//	maxsubst_ per column left (or per row, whichever are fewer), less the
+//	slack xdrop_ (see dynamic.h).
+
+bool dynamic::hopeless( float colmax, int j ) const
+{
+	int left = ylen_ - 1 - j;
+	if( left > xlen_ )
+	{
+		left = xlen_;
+	}
+
+	double potential = maxsubst_ * left - ( xdrop_ > 0 ? xdrop_ : 0 );
+
+	double t = threshold();
+	return ( score_ < t && colmax + potential < t - 1e-3 );
+}
+
+/******************************************************************************/
+
+// the first and last rows of column j inside the band. Without a band these
+//	are all the rows. The last one can be smaller than
+//	the first if the band does not cross the column.
+
+int dynamic::bandlo( int j ) const
+{
+	if( bandwidth_ < 0 )
+	{
+		return 0;
+	}
+	int lo = j - diagonal_ - bandwidth_;
+	return ( lo > 0 ) ? lo : 0;
+}
+
+int dynamic::bandhi( int j ) const
+{
+	if( bandwidth_ < 0 )
+	{
+		return xlen_ - 1;
+	}
+	int hi = j - diagonal_ + bandwidth_;
+	return ( hi < xlen_ - 1 ) ? hi : xlen_ - 1;
+}
+
+/******************************************************************************/
+
 // tracepath() traces the aligned portions of the sequence. It then stores the
 //	regions of the two sequences in strings, as well as an "align" string
 //	that has a '|' at every match on the alignment. The complexity is O(L),
-//	where L is the length of the aligned region.
+//	where L is the length of the aligned region, once the pointers are
+//	available.
 
 void dynamic::tracepath( void )
 {
-	dna& dna1( *dna1ptr_ ), & dna2( *dna2ptr_ );
-	int i = xend_, j = yend_;
-
-	// perform first pass to determine the starting point of the alignment
-	while( ptrMatrix_[i][j] != PTRNULL )
+	// without the pointer matrix, realign the sequences with the full
+	// matrices first, or with checkpoints if these would not fit
+	int xlen = xlen_;
+	int step = 0;
+	vector<float> hsaved, fsaved;
+	if( !full_ )
 	{
-		switch( ptrMatrix_[i][j] )
+		if( fits( xlen_, ylen_ ) )
 		{
-			case PTRDIAG:
-				i--;
-				j--;
-				pathlength_++;
-				break;
-			case PTRLEFT:
-				i--;
-				pathlength_++;
-				break;
-			case PTRUP:
-				j--;
-				pathlength_++;
-				break;
-			default:
-				cerr	<< "ERROR: Unrecognized pointer value "
-					<< "in dynamic programming ptrMatrix.\n"
-					<< "x = " << i << "; y = " << j << endl;
-				exit( EXIT_FAILURE );
+			dynmode md = mode_;
+			mode_ = DYNFULL;
+			input( *dna1ptr_, *dna2ptr_ );
+			mode_ = md;
+		}
+		else
+		{
+			step = checkpoint( hsaved, fsaved );
 		}
 	}
 
-	// set the beginning coordinates
-	xbegin_ = i;
-	ybegin_ = j;
-
-	// resize the alignment strings to the pathlength
-	top_.resize( pathlength_ );
-	bottom_.resize( pathlength_ );
-	align_.resize( pathlength_ );
+	dna& dna1( *dna1ptr_ ), & dna2( *dna2ptr_ );
+	int i = xend_, j = yend_;
+	int state = PTRDIAG;	// the path ends in H
 
-	i = xend_;
-	j = yend_;
+	// follow the path back to its starting point, i.e. the cell before
+	//	the first one, which has a NULL pointer or is outside the matrix.
+	//	The strings are filled in from the end, and reversed afterwards
+	pathlength_ = 0;
+	top_.clear();
+	bottom_.clear();
+	align_.clear();
 
 	double res = 0; // cache variable to store computed results
 
-	// then perform second pass to copy sequences into strings
-	for( int k = pathlength_-1; k >= 0 ; k-- )
+	while( score_ > 0 && i >= 0 && j >= 0 )
 	{
-		switch( ptrMatrix_[i][j] )
+		// with checkpoints, the pointers of the column are computed
+		// when the path enters its block
+		if( step > 0 && j < ptrcol_ )
+		{
+			block( j, step, hsaved, fsaved );
+		}
+
+		int move = trace( i, j, state );
+		if( move == PTRNULL )
+		{
+			break;
+		}
+		switch( move )
 		{
 			case PTRDIAG:
-				top_.at(k) = dna1.letter(i);
-				bottom_.at(k) = dna2.letter(j);
+				top_ += dna1.letter(i);
+				bottom_ += dna2.letter(j);
 				res = compare( dna1[i], dna2[j] );
 				if( res == 1 )
 				{
-					align_.at(k) = '|';
+					align_ += '|';
 				}
 				else if ( res == 0 )
 				{
-					align_.at(k) = ' ';
+					align_ += ' ';
 				}
 				else
 				{
-					align_.at(k) = ':';
+					align_ += ':';
 				}
 				i--;
 				j--;
 				break;
 			case PTRLEFT:
-				top_.at(k) = dna1.letter(i);
-				bottom_.at(k) = '-';
-				align_.at(k) = ' ';
+				top_ += dna1.letter(i);
+				bottom_ += '-';
+				align_ += ' ';
 				i--;
 				break;
 			case PTRUP:
-				top_.at(k) = '-';
-				bottom_.at(k) = dna2.letter(j);
-				align_.at(k) = ' ';
+				top_ += '-';
+				bottom_ += dna2.letter(j);
+				align_ += ' ';
 				j--;
 				break;
-
-			// the last nucleotide has been reached
-			default:
-				top_.at(k) = dna1.letter(i);
-				bottom_.at(k) = dna2.letter(j);
-				res = compare( dna1[i], dna2[j] );
-				if( res == 1 )
-				{
-					align_.at(k) = '|';
-				}
-				else if( res == 0 )
-				{
-					align_.at(k) = ' ';
-				}
-				else
-				{
-					align_.at(k) = ':';
-				}
 		}
+		pathlength_++;
 	}
+
+	// set the beginning coordinates
+	xbegin_ = i;
+	ybegin_ = j;
+
+	reverse( top_.begin(), top_.end() );
+	reverse( bottom_.begin(), bottom_.end() );
+	reverse( align_.begin(), align_.end() );
+
+	// the checkpoints only covered the rows up to the end of the path
+	xlen_ = xlen;
 	return;
 }
 
 /******************************************************************************/
 
+// prepare a traceback without the full matrices (see dynamic.h, 3.5). The
+//	columns of H and F up to the end of the alignment, and up to its row,
+//	are saved every step columns, xlen_ being the number of rows saved
+//	until tracepath() is done. Returns step.
+
+int dynamic::checkpoint( vector<float>& hsaved, vector<float>& fsaved )
+{
+	// the end of a DYNSCORE alignment may be another cell of the same
+	// score, found by the vectorized kernel or before stopping at
+	// significance, so the end chosen by the full alignment of the scalar
+	// algorithm is found first
+	if( mode_ == DYNSCORE )
+	{
+		score_ = 0;
+		xend_ = yend_ = 0;
+		gotoh( false );
+	}
+	else
+	{
+		unpack();
+	}
+
+	// the cells after the end of the alignment can not be on its path, and
+	// those before it do not depend on them
+	xlen_ = xend_ + 1;
+	int columns = yend_ + 1;
+	int step = static_cast<int>( sqrt( 8.0 * columns ) ) + 1;
+	int blocks = ( columns + step - 1 ) / step;
+
+	hsaved.resize( static_cast<size_t>( blocks ) * xlen_ );
+	fsaved.resize( static_cast<size_t>( blocks ) * xlen_ );
+	hScr_.assign( xlen_, 0 );
+	fScr_.assign( xlen_, 0 );
+	for( int b = 0; b < blocks; b++ )
+	{
+		size_t start = static_cast<size_t>( b ) * xlen_;
+		for( int i = 0; i < xlen_; i++ )
+		{
+			hsaved[ start + i ] = hScr_[i];
+			fsaved[ start + i ] = fScr_[i];
+		}
+		sweep( b * step, min( ( b+1 ) * step, columns ), false, false,
+			false );
+	}
+
+	// no block of pointers is computed yet
+	ptrMatrix_.resize( static_cast<size_t>( step ) * xlen_ );
+	ptrcol_ = columns;
+	return step;
+}
+
+/******************************************************************************/
+
+// recompute the pointers of the block of columns holding column j, from the
+//	checkpoint at its start. Only the columns up to j are needed, since the
+//	path never goes back to later columns.
+
+void dynamic::block( int j, int step, const vector<float>& hsaved,
+	const vector<float>& fsaved )
+{
+	int b = j / step;
+	size_t start = static_cast<size_t>( b ) * xlen_;
+
+	hScr_.assign( hsaved.begin() + start, hsaved.begin() + start + xlen_ );
+	fScr_.assign( fsaved.begin() + start, fsaved.begin() + start + xlen_ );
+	ptrcol_ = b * step;
+	sweep( ptrcol_, j + 1, false, false, true );
+}
+
+/******************************************************************************/
+
+// the move out of cell (i,j) of a path in the given state. In H (PTRDIAG) it is
+//	the move that produced the score of the cell; in E (PTRLEFT) or F
+//	(PTRUP) the path follows the gap. The state then becomes that of the
+//	next cell: the gap goes on if it was extended, and H follows a gap
+//	opening or a diagonal move.
+
+int dynamic::trace( int i, int j, int& state )
+{
+	int p = ptr( i, j );
+	int move = ( state == PTRDIAG ) ? ( p & PTRMOVE ) : state;
+
+	switch( move )
+	{
+		case PTRLEFT:
+			state = ( p & PTRLEFTX ) ? PTRLEFT : PTRDIAG;
+			break;
+		case PTRUP:
+			state = ( p & PTRUPX ) ? PTRUP : PTRDIAG;
+			break;
+		default:
+			state = PTRDIAG;
+	}
+	return move;
+}
+
+/******************************************************************************/
+
 // retrieve the maximum value from a float array of length l (returns its index)
 
 int dynamic::max( float* farray, int l )
@@ -22,12 +22,45 @@ the dynamic object. Other data members are classified below.
 		- scrMatrix: the matrix of scores used by the dynamic
 	programming algorithm.
 		- ptrMatrix: the matrix of pointers used by the dynamic
-	programming algorithm.
+	programming algorithm, for tracepath(). Each pointer holds the move
+	that produced the score of its cell, and whether its gap states
+	extend those of the neighbouring cells (see 3.1 below).
+	Both matrices are stored in a single contiguous vector each, column
+	after column, i.e. in the order in which align() computes them.
+		- hScr, fScr: the column of scores and the column of vertical
+	gap states being computed, which hold the previous column until they
+	are overwritten. They are all the algorithm needs, so the matrices
+	are only filled in for tracepath().
+		- mode: whether the full matrices are kept (DYNFULL) or only the
+	columns (DYNSCORE). See 3.2 below.
+		- full: whether the matrices hold the last alignment, which is
+	not the case in DYNFULL mode if they would have more than DYNMAXCELLS
+	cells. See 3.5 below.
+		- ptrcol: the first column held by the pointer matrix, which only
+	holds a block of columns during a checkpointed traceback (0 otherwise).
 
 		- match, msmatch, gapopen, gapxtnd: the rewards and penalties
 	used by the algorithm.
+		- fsubst, isubst: substitution tables, holding the score of
+	aligning each pair of nucleotide codes (the match strength times the
+	match reward, or the mismatch penalty). They are rebuilt whenever the
+	rewards and penalties change, so the algorithm never needs to call
+	compare(). isubst holds the same scores as integers, scaled by the
+	smallest factor (scale) that makes them integral, for the vectorized
+	kernel. bscale is the smaller factor enough for the scores of the
+	four bases alone, if any (see 3.7 below).
+		- maxsubst: the highest substitution score, i.e. the most an
+	alignment can gain per nucleotide (used by the X-drop mode).
+		- bandwidth, diagonal: the band to which the alignment is
+	restricted, if any (DYNNOBAND otherwise). See 3.4 below.
+		- xdrop: the X-drop value (DYNNOXDROP if the X-drop mode is
+	off). See 3.4 below.
 		- aligned: flag to indicate whether the sequences have been
 	aligned.
+		- cells, stopped, abandoned: the number of cells computed by
+	the last alignment (or batch), and how many of its alignments
+	stopped at significance or were abandoned in X-drop mode before
+	their last cell.
 		- significance: the number of consecutive matching nucleotides
 	needed to achieve significance. The algorithm has the option to stop
 	the alignment once significance has been reached.
@@ -68,10 +101,13 @@ displayed if the alignment is not significant.
 	arguments and initializes all the variables needed for alignment, and
 	aligns the sequences. The printout variables are not computed since
 	only a few applications will need printing of the alignment.
-		- copy constructor: All items are copied.
+		- copy constructor: All items are copied, except the matrices
+	of an object that has not aligned anything (e.g. a prototype copied by
+	every thread) and the workspace columns.
 
 	The destructor and assignment operator for the class work as would be
-expected.
+expected. As with class dna (see dna.h), swap() stands in for a move
+constructor: it exchanges two objects without copying their matrices.
 
 	2.3. "GET" FUNCTIONS
 
@@ -84,45 +120,198 @@ constructor, is recommended wherever possible).
 
 	aligned() verifies that the sequences have been aligned.
 
+	cells() returns the number of cells computed by the last input() or
+batch(): those of the columns swept, of their bands for banded alignments, so
+fewer than the whole matrix when the alignment stopped early. stopped() and
+abandoned() return how many of the alignments stopped at significance, and
+how many were abandoned in X-drop mode (see 3.4), before their last cell (0 or
+1 after input()). They are meant for profiles (see profile.h). The kernels
+compute whole columns, and the batch kernel two at a time, so their counts
+are those of the columns they computed.
+
+	match(), msmatch(), gapopen(), gapxtnd() and significance() return the
+alignment rewards, penalties and significance length, e.g. to tell whether a
+stored result was computed with the same parameters (see diskcache.h).
+
 	significant() verifies that the alignment is significant (i.e. the
 sequences are more similar than a threshold). The threshold value for
 significance is defined below, and can be changed by the user as an optional
-argument to the constructor.
+argument to the constructor. Given a score, it tells whether that score is
+significant, e.g. for the scores of batch().
+
+	integral() gives the substitution table, gap penalties and significance
+threshold in the integer units of the vectorized kernel, for other
+implementations of the same alignment (see device.h). It returns false if the
+scores are not integral once scaled.
 
 	2.4. "SET" FUNCTIONS
 
 	input() allows the user to change the sequences being held by the
 object. This function is provided for circumstances in which the default
-constructor for the class had to be called.
+constructor for the class had to be called. It is also the way to reuse a
+dynamic object as a workspace for many alignments: the matrices are kept
+between calls and only grow when a larger pair of sequences is input.
 
 	match(), msmatch(), gapopen() and gapxtnd() modify the alignment
 rewards and penalties as specified. Similarly for wrap().
 
+	mode() sets the alignment mode (DYNFULL or DYNSCORE) used by the next
+alignment. The mode can also be given as an argument to any of the
+constructors.
+
+	band() restricts the next alignments to a band of the given width around
+a diagonal, and unband() lifts the restriction. xdrop() sets the X-drop value
+(DYNNOXDROP turns the mode off). The X-drop value, bandwidth and diagonal can
+also be given as the last arguments to any of the constructors. See 3.4.
+
 	significance() allows the user to change the significance level of the
 alignment. The significance level is defined as the number of consecutive
 matching nucleotides needed in the two sequences to achieve significance.
 
 	2.5. OTHER FUNCTIONS
 
+	batch() aligns one x-sequence against many y-sequences, and returns
+their scores (see 3.6).
+
 	The function tracepath() traces the alignment from the highest-scoring
 cell in the score matrix to the starting cell. The traces are used for the
-output of the alignment.
+output of the alignment. Alignments too large for the full matrices are traced
+with checkpoints (see 3.5).
 
 3. NOTES
 
 	3.1. THE align() FUNCTION
 
 	align() is the core of the dynamic class and consists of the dynamic
-programming algorithm for local sequence alignment.
-
-	3.2. FUTURE MODIFICATIONS
-
-	Certain specialized uses of dynamic may only need the score of the
-alignment. In these cases only two columns of the score and pointer matrices
-are needed at a time. This reduces space necessity considerably. Thus a
-different dynamic class may be created for these cases. Ideally a base class
-will be created containing the base components of a dynamic programming
-algorithm, and specialized classes will be derived from that.
+programming algorithm for local sequence alignment, with affine gap penalties
+(Gotoh's algorithm). Three scores are kept for every cell (i, j): H, the best
+score of an alignment ending at the cell; E, the best score of one ending with
+a gap in the y-sequence (a move LEFT, from cell (i-1, j)); and F, the best
+score of one ending with a gap in the x-sequence (a move UP, from (i, j-1)):
+
+	E(i,j) = max( H(i-1,j) + gapopen, E(i-1,j) + gapxtnd )
+	F(i,j) = max( H(i,j-1) + gapopen, F(i,j-1) + gapxtnd )
+	H(i,j) = max( 0, H(i-1,j-1) + subst(i,j), E(i,j), F(i,j) )
+
+with H = E = F = 0 outside the matrix. E only depends on the cell above in the
+same column, so it is kept in a single variable; F and H are kept in the two
+columns hScr and fScr. The scores are the exact optimal local alignment scores,
+the same as those of the vectorized kernel (see striped.h). The pointer of each
+cell holds the move that produced H (PTRNULL if it is 0), and the flags PTRLEFTX
+and PTRUPX if E and F extend a gap rather than open one, so that tracepath() can
+follow the gap states.
+
+	3.2. SCORE-ONLY ALIGNMENT
+
+	Certain specialized uses of dynamic (e.g. clustering) only need the
+score of the alignment, or whether it is significant. In these cases only two
+columns of the score and pointer matrices are needed at a time: the column
+being computed and the previous one, which share the hScr and fScr columns (see
+3.1). This is the DYNSCORE mode, and it reduces space usage from O(n*m) to
+O(n).
+
+	Since no pointer matrix is available in DYNSCORE mode, tracepath()
+(and therefore operator<<) first realigns the sequences in DYNFULL mode, or
+with checkpoints if the full matrices would be too large (see 3.5).
+
+	3.3. VECTORIZED ALIGNMENT
+
+	In DYNSCORE mode the alignment is performed by the SIMD kernel of class
+striped (see striped.h) whenever the CPU supports it and the rewards and
+penalties can be represented as integers. The query profile of the x-sequence
+is kept between alignments, so aligning one sequence against many others with
+the same object (as exest does) only builds it once. The kernel computes the
+same recurrence as align() (see 3.1), so both give the same scores, but for the
+rounding errors of the floating-point scores of align(): a score the kernel
+makes exactly 36 can be 35.99999 there. When the scores are integral once
+scaled, a score is therefore significant if its scaled value, rounded to the
+nearest integer, reaches the threshold of the kernel (rounded up), so that
+align(), the kernels and the device all find the same pairs significant.
+Otherwise it only has to come within 1e-3 of the threshold. The scalar
+algorithm is used as a fallback if the kernel can not be used or its scores
+overflow.
+
+	3.4. BANDED AND X-DROP ALIGNMENT
+
+	Two related sequences share a long alignment close to a single diagonal
+of the matrix (the offset j - i between the positions of its nucleotides), and
+this diagonal can be found cheaply from their shared k-mers (see kmer.h). In
+banded mode only the cells (i, j) with |j - i - diagonal| <= bandwidth are
+computed, and all the others are taken to be 0, so an alignment of two
+sequences of length n costs O(n*bandwidth) instead of O(n*n). Alignments
+straying further from the diagonal are missed. The banded alignment is always
+performed by the scalar algorithm.
+
+	In X-drop mode, an alignment stopping at significance (s = true) is
+abandoned as soon as the threshold can no longer be reached. At the end of each
+column, no alignment can score more than the best cell of the column plus
+maxsubst for each nucleotide left in the shorter remaining part of the
+sequences. This bound assumes that the rest of the alignment is perfect, so it
+only rejects an unrelated pair in the last columns of the matrix; the xdrop
+value is a slack subtracted from it, assuming that an alignment loses at least
+that much of the highest possible gain on the way. An xdrop of 0 thus only
+abandons alignments that can not become significant, and every unit of slack
+rejects unrelated pairs about 1/maxsubst columns earlier, at the risk of
+missing significant alignments that end close to the end of the sequences. The
+score of an abandoned alignment is that of the part performed, below the
+threshold. Alignments with s = false are not affected.
+
+	3.5. CHECKPOINTED TRACEBACK
+
+	The full matrices take 5 bytes per cell, i.e. gigabytes for a contig of
+tens of kilobases against an EST. When they would have more than DYNMAXCELLS
+cells, DYNFULL alignments are performed like DYNSCORE ones (by the scalar
+algorithm, so that they end on the same cell), and tracepath() recomputes the
+pointers it needs instead: only the cells up to the end of the alignment
+(xend, yend) matter, and of them the columns of H and F are saved every step
+columns by a first score-only pass. The traceback, which only moves to earlier
+columns, then recomputes the pointers of one block of step columns at a time
+from the checkpoint before it. With step close to sqrt(8 * yend), the memory
+used is O(xend * sqrt(yend)) instead of O(xlen * ylen), for twice the time of
+an alignment. The pointers, and thus the path, are the same as those of the
+full matrices.
+
+	3.6. BATCHES
+
+	Aligning one sequence against many others (a row of the pairs in exest,
+or the pending pairs of gaest, see allpairs.h) in DYNSCORE mode, the targets
+can be given to batch() together. It aligns them a register's worth at a time
+with the batch kernel of striped (see striped.h), the query profile being
+built once, and returns the scores of all of them. Stopping at significance
+(s) and the X-drop mode work as with input(), so the pairs found significant
+are the same, even when a pair left to the scalar algorithm scores a rounding
+error below the threshold (see 3.3), and so are the scores if s is false. The
+end coordinates are not kept, and the object holds no alignment afterwards.
+
+	On ESTs of a few hundred nucleotides, whose scaled scores need 16 bits,
+the striped kernel already keeps its lanes busy, and the batch kernel is only
+about as fast once it has enough targets to keep refilling its lanes: it is
+given at least DYNBATCH of them. Shorter lists, and the pairs the kernel can
+not align (in banded or DYNFULL mode, or if their scores overflow), are aligned
+one by one.
+
+	3.7. NARROW SCORES
+
+	The scale of the integer scores is set by the strengths of the partial
+matches of the ambiguous nucleotides (1/2, 1/3, 2/9, ...): with the default
+rewards and penalties it is 180, so a match scores 180 and the significance
+threshold is 6480. The 8-bit kernel is then never used, and a 16-bit score
+overflows after some 180 matching nucleotides, when the kernel has to give the
+alignment to the scalar algorithm. The scores of the bases alone (A, C, G and
+T) need a much smaller scale, 5 with the default rewards and penalties, of
+which the full scale is a multiple: the threshold is then 180, so the 8-bit
+kernels (with twice as many lanes) can stop at significance, and a 16-bit
+score holds thousands of matches. Integer rewards and penalties narrow the
+same way.
+
+	A second striped kernel (bkernel) is therefore scored in the units of
+the bases, and it aligns the pairs of sequences that are made of bases only
+(see dna.h, bases()), which are nearly all the pairs of an EST library, while
+the others keep the full scale. The scores of one kernel are ratio = scale /
+bscale times those of the other for the same pair, so the stop, reject and
+slack arguments are converted (rounding up, see limits()) such that both
+kernels stop and abandon the alignments at the same cells, and the results
+are the same whichever kernel aligns a pair.
 
 	*/
 
@@ -133,6 +322,7 @@ algorithm, and specialized classes will be derived from that.
 #include <vector>
 #include <string>
 #include "dna.h"
+#include "striped.h"
 
 // default rewards and penalties for alignment
 const float DYNMATCH = 1.0;
@@ -145,11 +335,27 @@ const int DYNSIG = 40;	// default minimal length of aligned region considered
 
 const int DYNWRAP = 60;	// default printing wrap value
 
+const int DYNSCALE = 1000;	// largest factor tried to make scores integral
+
+const double DYNMAXCELLS = 1 << 24;	// the largest full matrices, beyond
+					// which tracepath() uses checkpoints
+const int DYNBATCH = 256;	// the fewest targets batch() gives the kernel
+
+const int DYNNOBAND = -1;	// bandwidth of an unbanded alignment
+const float DYNNOXDROP = -1;	// X-drop value when the mode is off
+
 // ints to represent pointers in dynamic programming algorithm
 const int PTRNULL = 0;
 const int PTRLEFT = 1;
 const int PTRUP = 2;
 const int PTRDIAG = 3;
+const int PTRMOVE = 3;		// the bits of a pointer holding one of the above
+const int PTRLEFTX = 4;		// E extends the gap of the cell on the left
+const int PTRUPX = 8;		// F extends the gap of the cell above
+
+// alignment modes: keep the full score and pointer matrices (needed for
+// tracepath()), or only two rolling columns of each (score only)
+enum dynmode { DYNFULL, DYNSCORE };
 
 class dynamic
 {
@@ -158,37 +364,120 @@ class dynamic
 		// constructors, destructor, assignment operator
 		dynamic( float m = DYNMATCH, float mm = DYNMSMATCH,
 			float go = DYNGAPOPEN, float gx = DYNGAPXTND,
-			int sl = DYNSIG );
+			int sl = DYNSIG, dynmode md = DYNFULL,
+			float xd = DYNNOXDROP, int bw = DYNNOBAND, int dg = 0 );
 		dynamic( dna&, dna&, bool s = false, int sl = DYNSIG,
 			float m = DYNMATCH, float mm = DYNMSMATCH,
-			float go = DYNGAPOPEN, float gx = DYNGAPXTND );
+			float go = DYNGAPOPEN, float gx = DYNGAPXTND,
+			dynmode md = DYNFULL, float xd = DYNNOXDROP,
+			int bw = DYNNOBAND, int dg = 0 );
 		dynamic( const dynamic& );
 		dynamic& operator=( const dynamic& );
+		void swap( dynamic& );
 		~dynamic();
 
 		// "get" functions
 		dna& dna1( void ) const { return (*dna1ptr_); }
 		dna& dna2( void ) const { return (*dna2ptr_); }
 		float score( void ) const { return score_; }
+		double cells( void ) const { return cells_; }
+		int stopped( void ) const { return stopped_; }
+		int abandoned( void ) const { return abandoned_; }
 		int pathlength() const { return pathlength_; }
 		bool aligned( void ) const { return aligned_; }
+		dynmode mode( void ) const { return mode_; }
+		int bandwidth( void ) const { return bandwidth_; }
+		int diagonal( void ) const { return diagonal_; }
+		float xdrop( void ) const { return xdrop_; }
+		float match( void ) const { return match_; }
+		float msmatch( void ) const { return msmatch_; }
+		float gapopen( void ) const { return gapopen_; }
+		float gapxtnd( void ) const { return gapxtnd_; }
+		int significance( void ) const { return significance_; }
 		bool significant( void );
+		bool significant( float sc ) const { return reaches( sc ); }
+		bool integral( int*, int&, int&, int& ) const;
 
 		// "set" functions
 		void input( dna&, dna&, bool s = false );
-		void match( float m ) { match_ = m; aligned_ = false; }
-		void msmatch( float m ) { msmatch_ = m; aligned_ = false; }
-		void gapopen( float g ) { gapopen_ = g; aligned_ = false; }
-		void gapxtnd( float g ) { gapxtnd_ = g; aligned_ = false; }
+		void match( float m ) { match_ = m; scoring(); }
+		void msmatch( float m ) { msmatch_ = m; scoring(); }
+		void gapopen( float g ) { gapopen_ = g; scoring(); }
+		void gapxtnd( float g ) { gapxtnd_ = g; scoring(); }
 		void wrap( int w ) { wrap_ = w; }
 		void significance( int n ) { significance_ = n; }
+		void mode( dynmode md ) { mode_ = md; aligned_ = false; }
+		void band( int d, int w )
+			{ diagonal_ = d; bandwidth_ = w; aligned_ = false; }
+		void unband( void ) { bandwidth_ = DYNNOBAND; aligned_ = false; }
+		void xdrop( float x ) { xdrop_ = x; aligned_ = false; }
 
 		// other functions
+		void batch( dna&, const vector<dna*>&, vector<float>&,
+			bool s = false );
 		void tracepath( void );
 	private:
 		// alignment function for use on initialization
 		void align( bool s = false );
 
+		// score-only alignment, with the vectorized kernel if possible
+		// (DYNSCORE)
+		void alignscore( bool s = false );
+
+		// the stop, reject and slack arguments of the kernel, in its
+		// integer units, or in those ratio times larger of the kernel
+		// of the bases (see 3.7)
+		void limits( bool s, int&, int&, int&, int ratio = 1 ) const;
+
+		// can a pair be aligned by the kernel of the bases?
+		bool narrow( const dna& x, const dna& y ) const
+			{ return bscale_ > 0 && x.bases() && y.bases(); }
+
+		// the three-state recurrence shared by both modes (see 3.1),
+		// and its loop over some of the columns, which keeps their
+		// scores and pointers in the matrices if asked to
+		void gotoh( bool s );
+		double sweep( int, int, bool, bool, bool );
+
+		// the checkpoints of a traceback without the full matrices,
+		// and the recomputation of the block of pointers holding a
+		// column (see 3.5)
+		int checkpoint( vector<float>&, vector<float>& );
+		void block( int, int, const vector<float>&,
+			const vector<float>& );
+
+		// can the full matrices of an x by y alignment be kept?
+		static bool fits( int x, int y )
+			{ return static_cast<double>( x ) * y <= DYNMAXCELLS; }
+
+		// the move out of cell (i,j) of a path in the given state
+		// (PTRDIAG for H, PTRLEFT for E, PTRUP for F), which becomes
+		// the state of the next cell
+		int trace( int, int, int& );
+
+		// does a score reach the significance threshold (see 3.3), and
+		// has the score of the alignment reached it?
+		bool reaches( double ) const;
+		bool reached( void ) const { return reaches( score_ ); }
+		double threshold( void ) const;
+
+		// can the threshold no longer be reached after column j, whose
+		// best cell scores colmax? (X-drop mode)
+		bool hopeless( float colmax, int j ) const;
+
+		// the first and last rows of column j inside the band
+		int bandlo( int j ) const;
+		int bandhi( int j ) const;
+
+		// build the substitution tables from the rewards and
+		// penalties (called whenever these change)
+		void scoring( void );
+		static bool integral( double );
+
+		// unpack the nucleotide codes of both sequences for the
+		// alignment loops
+		void unpack( void );
+
 		// copy and destroy functions used by copy constructor,
 		// assignment operator and destructor.
 		void copy( const dynamic& );
@@ -197,6 +486,12 @@ class dynamic
 		// helper function for align()
 		inline int max( float*, int );
 
+		// access to cell (i,j) of the score and pointer matrices
+		float& scr( int i, int j )
+			{ return scrMatrix_[ j * xlen_ + i ]; }
+		char& ptr( int i, int j )
+			{ return ptrMatrix_[ ( j - ptrcol_ ) * xlen_ + i ]; }
+
 	private:
 		dna* dna1ptr_;	// the first (x-value) dna sequence
 		dna* dna2ptr_;	// the second (y-value) dna sequence
@@ -205,15 +500,29 @@ class dynamic
 
 		int xlen_, ylen_;	// length of _dna1 and _dna2 sequences
 
-		vector< vector<float> >
-			scrMatrix_;	// the score matrix
-		vector< vector<int> >
-			ptrMatrix_;	// the pointer matrix
+		vector<float> scrMatrix_;	// the score matrix
+		vector<char> ptrMatrix_;	// the pointer matrix
+
+		vector<float> hScr_;	// the column of scores (H)
+		vector<float> fScr_;	// the column of vertical gaps (F)
+
+		vector<unsigned char> xcodes_;	// the unpacked nucleotides of
+		vector<unsigned char> ycodes_;	// _dna1 and _dna2
+
+		dynmode mode_;		// full matrices or score only
+		bool full_;		// do the matrices hold the alignment?
+		int ptrcol_;		// the first column of the pointers
+		striped kernel_;	// vectorized kernel for DYNSCORE mode
 
 		int xbegin_, ybegin_;	// coordinates of start of alignment
 		int xend_, yend_;	// coordinates of end of alignment
 		int pathlength_;	// the length of the aligned region
 
+		double cells_;		// the cells computed by the last
+					// alignment or batch
+		int stopped_;		// how many of its alignments stopped
+		int abandoned_;		// at significance, or were abandoned
+
 		string top_;		// the aligned region of _dna1
 		string bottom_;		// the aligned region of _dna2
 		string align_;		// match sequence of aligned region
@@ -224,6 +533,21 @@ class dynamic
 		float gapopen_;		// (negative value = penalty)
 		float gapxtnd_;
 
+		float fsubst_[DNACODES * DNACODES];
+					// score of each pair of nucleotides
+		int isubst_[DNACODES * DNACODES];
+					// the same, scaled to integers
+		int scale_;		// the scaling factor of isubst_
+		bool exact_;		// are the scores integral once scaled?
+		int bscale_;		// the scaling factor of the scores of
+					// the bases (0 if not smaller)
+		striped bkernel_;	// vectorized kernel scoring them
+		float maxsubst_;	// the highest substitution score
+
+		int bandwidth_;		// the band around diagonal_ (j - i) to
+		int diagonal_;		// which the alignment is restricted
+		float xdrop_;		// the X-drop value
+
 		bool aligned_;		// have the dna sequences been aligned?
 		int significance_;	// what is the minimum length of a
 					// significant alignment?
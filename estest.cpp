@@ -5,32 +5,46 @@ Title:	Useful program to test the input of gaest, the est clustering program
 Descr:	invoke the program with the file containing the sequences as a command-
 		line argument. The program will not check that the file exists
 		or that the call was correct.
+		Command 4 checks that the banded alignments of the engine of
+		gaest and exest (see allpairs.h) are the same with one thread,
+		with several threads, and pair by pair as in check() of gaest.
+		Command 5 checks that the scalar alignment (DYNFULL) and the
+		kernels (DYNSCORE) find the same pairs significant, among
+		random sequences aligned with the next one (often related)
+		and with another one at random.
+		Command 6 checks that batch() finds the same pairs significant
+		as input(), and gives the same scores without stopping at
+		significance, for random rows of the sequences against all the
+		others.
 	*/
 
 
 #include <iostream>
 #include <vector>
-#include <fstream>
+#include <cstdlib>
 #include "dna.h"
 #include "dynamic.h"
+#include "kmer.h"
+#include "allpairs.h"
+#include "fasta.h"
 
 int main( int argc, char** argv )
 {
 	vector<dna> sequences;
-	dna temp;
-	ifstream datafile( argv[1], ios::in );
+	fasta datafile( argv[1] );
 
 	cerr	<< "File open. Reading in sequences" << endl;
 
-	while( datafile >> temp )
+	for( int k = datafile.read( sequences ); k > 0; k-- )
 	{
 		cerr	<< "Sequence read." << endl;
-		sequences.push_back(temp);
 	}
 
 	cerr	<< "Sequences are ready." << endl;
-	cout	<< "Enter command: 1-print, 2-align." << endl;
-	int c, i, j;
+	cout	<< "Enter command: 1-print, 2-align, 3-swap, 4-band, "
+		"5-significance, 6-batch." << endl;
+	int c, i, j, w, t, p;
+	float x;
 	while( cin >> c )
 	{
 		if( c == 1 )
@@ -46,7 +60,178 @@ int main( int argc, char** argv )
 			dynamic d1( sequences[i], sequences[j] );
 			cout	<< d1 << endl;
 		}
-		cout	<< "Enter command: 1-print, 2-align." << endl;
+		if( c == 3 )
+		{
+			// an alignment swapped into another object must stay
+			// the same, and the object swapped out empty
+			cout	<< "Which sequences?" << endl;
+			cin	>> i >> j;
+			dynamic d1( sequences[i], sequences[j] ), d2;
+			d2.swap( d1 );
+			cout	<< "Swapped: aligned " << d2.aligned()
+				<< ", significant " << d2.significant()
+				<< ", score " << d2.score() << " (left: aligned "
+				<< d1.aligned() << ")" << endl;
+			d1.swap( d2 );
+			cout	<< d1 << endl;
+		}
+		if( c == 4 )
+		{
+			// the engine must keep the same pairs whatever its number
+			// of threads, and the same as aligning them one by one
+			cout	<< "Which band width and number of threads?" << endl;
+			cin	>> w >> t;
+			kmers sketches;
+			sketches.build( sequences );
+			dynamic proto( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, DYNGAPXTND,
+				DYNSIG, DYNSCORE );
+			int n = static_cast<int>( sequences.size() ), diagonal;
+
+			vector< pair<int, int> > expected;
+			dynamic d1( proto );
+			for( i = 0; i < n; i++ )
+			{
+				for( j = i+1; j < n; j++ )
+				{
+					if( !sketches.pass( i, j ) )
+					{
+						continue;
+					}
+					if( sketches.diagonal( i, j, diagonal ) )
+					{
+						d1.band( diagonal, w );
+					}
+					else
+					{
+						d1.unband();
+					}
+					d1.input( sequences[i], sequences[j], true );
+					if( d1.significant() )
+					{
+						expected.push_back
+							( pair<int, int>( i, j ) );
+					}
+				}
+			}
+
+			allpairs single( sequences, proto, 1 );
+			allpairs several( sequences, proto, t );
+			single.filter( &sketches );
+			several.filter( &sketches );
+			single.band( w );
+			several.band( w );
+			single.run();
+			several.run();
+			cout	<< "Pair by pair: " << expected.size()
+				<< " edges; 1 thread: " << single.edges().size()
+				<< ( single.edges() == expected ? " (same)" :
+					" (DIFFERENT)" )
+				<< "; " << several.threads() << " threads: "
+				<< several.edges().size()
+				<< ( several.edges() == expected ? " (same)" :
+					" (DIFFERENT)" ) << endl;
+		}
+		if( c == 5 )
+		{
+			// the scores of the scalar alignment can be a rounding
+			// error below those of the kernels, which must not make
+			// a pair at the threshold not significant
+			cout	<< "How many random sequences?" << endl;
+			cin	>> p;
+			dynamic full( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, DYNGAPXTND,
+				DYNSIG, DYNFULL );
+			dynamic score( DYNMATCH, DYNMSMATCH, DYNGAPOPEN,
+				DYNGAPXTND, DYNSIG, DYNSCORE );
+			int n = static_cast<int>( sequences.size() );
+			int found = 0, differ = 0;
+			streamsize precision = cout.precision( 10 );
+			srand( 1 );
+			for( int k = 0; k < 2 * p; k++ )
+			{
+				i = ( k % 2 ) ? i : rand() % n;
+				j = ( k % 2 ) ? rand() % n : ( i + 1 ) % n;
+				full.input( sequences[i], sequences[j] );
+				score.input( sequences[i], sequences[j], true );
+				if( full.significant() )
+				{
+					found++;
+				}
+				if( full.significant() != score.significant() )
+				{
+					differ++;
+					cout	<< "Pair " << i << ", " << j
+						<< ": " << full.score() << " and "
+						<< score.score() << endl;
+				}
+			}
+			cout	<< "Pairs: " << 2 * p << ", significant: " << found
+				<< ", different: " << differ << endl;
+			cout.precision( precision );
+		}
+		if( c == 6 )
+		{
+			// batch() gives the kernel lists of at least DYNBATCH
+			// targets, so each row is aligned against all the other
+			// sequences
+			cout	<< "How many random rows, and which X-drop value "
+				"(-1: none)?" << endl;
+			cin	>> p >> x;
+			dynamic many( DYNMATCH, DYNMSMATCH, DYNGAPOPEN,
+				DYNGAPXTND, DYNSIG, DYNSCORE, x );
+			dynamic one( many );
+			int n = static_cast<int>( sequences.size() );
+			int pairs = 0, found = 0, differ = 0, scores = 0;
+			vector<dna*> ys;
+			vector<int> targets;
+			vector<float> stopped, full;
+			srand( 1 );
+			for( int k = 0; k < p; k++ )
+			{
+				i = rand() % n;
+				ys.clear();
+				targets.clear();
+				for( j = 0; j < n; j++ )
+				{
+					if( j != i )
+					{
+						ys.push_back( &sequences[j] );
+						targets.push_back( j );
+					}
+				}
+				many.batch( sequences[i], ys, stopped, true );
+				many.batch( sequences[i], ys, full, false );
+				for( int y = 0; y < static_cast<int>( ys.size() );
+					y++ )
+				{
+					j = targets[y];
+					one.input( sequences[i], sequences[j], true );
+					pairs++;
+					if( one.significant() )
+					{
+						found++;
+					}
+					if( one.significant()
+						!= many.significant( stopped[y] ) )
+					{
+						differ++;
+						cout	<< "Pair " << i << ", " << j
+							<< ": " << one.score()
+							<< " and " << stopped[y]
+							<< endl;
+					}
+					one.input( sequences[i], sequences[j] );
+					if( one.score() != full[y] )
+					{
+						scores++;
+					}
+				}
+			}
+			cout	<< "Pairs: " << pairs << ", significant: " << found
+				<< ", different: " << differ
+				<< ", different scores: " << scores << endl;
+		}
+		cout	<< "Enter command: 1-print, 2-align, 3-swap, 4-band, "
+			"5-significance, 6-batch." << endl;
 	}
 
 	return 0;
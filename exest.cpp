@@ -2,82 +2,324 @@
 
 #include <iostream>
 #include <vector>
-#include <list>
 #include <ctime>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <iterator>
 #include "dna.h"
 #include "dynamic.h"
+#include "seqstore.h"
+#include "fasta.h"
+#include "kmer.h"
+#include "kmerindex.h"
+#include "allpairs.h"
+#include "clusters.h"
+#include "clusterstate.h"
+#include "device.h"
 
-const int NUMSEQS = 20;
-
-int traversecluster( vector<bool>&, vector< list<int> >&, int );
+void error( const string&, const string& );
 
+seqstore store;
 vector<dna> sequences;
-vector< vector<bool> > edges;
 
-int main( void )
+int main( int argc, char** argv )
 {
-	dna temp;
 	time_t start, end;
 
-	sequences.reserve( NUMSEQS );
+	// the number of alignment threads (0: one per processor), the length
+	// of the k-mers of the prefilter (0: no prefilter), and whether only
+	// the candidates of the k-mer index are aligned
+	int threads = 0;
+	int k = 0;
+	bool indexed = false;
+
+	// the width of the band around the diagonal of the shared k-mers, and
+	// the X-drop value (see dynamic.h), both off by default
+	int bandwidth = DYNNOBAND;
+	float xdrop = DYNNOXDROP;
+
+	// the state file of the streaming mode (see clusterstate.h), if any
+	string statefile;
 
-	while( cin >> temp )
+	// whether the pairs are aligned on a GPU (see device.h), if there is one
+	bool gpu = false;
+
+	const string errormsg( "Incorrect option syntax. Use -h for help." );
+	const string usage( "\nExhaustive EST clustering. Read in sequences "
+		"from stdin in FASTA format, align\nall the pairs and print "
+		"the clusters to stdout.\n\n"
+		"Available options:\n"
+		"\t-threads int:\tspecify the number of alignment threads.\n"
+			"\t\t\t0 (default) uses one per processor.\n"
+		"\t-k int:\t\tonly align the pairs sharing enough k-mers\n"
+			"\t\t\tof length int (at most 16). 0 (default)\n"
+			"\t\t\taligns all the pairs.\n"
+		"\t-index:\t\tonly align the candidate pairs of a k-mer\n"
+			"\t\t\tindex (implies -k 11 if -k is not given).\n"
+		"\t-band int:\tonly align the pairs in a band of width int\n"
+			"\t\t\taround the diagonal of their shared k-mers\n"
+			"\t\t\t(implies -k 11 if -k is not given).\n"
+		"\t-xdrop float:\tabandon the alignments that can no longer\n"
+			"\t\t\tbecome significant, allowing a slack of\n"
+			"\t\t\tfloat (0 is exact, larger values are faster).\n"
+		"\t-state file:\tstreaming mode: cluster the input together\n"
+			"\t\t\twith the sequences kept in file, aligning\n"
+			"\t\t\tonly the pairs involving a new sequence,\n"
+			"\t\t\tand keep them all in file for the next\n"
+			"\t\t\tbatch.\n"
+		"\t-gpu:\t\talign the pairs on a CUDA device, if there is\n"
+			"\t\t\tone (and not with -band).\n"
+		"\t-h(elp):\tprint this message.\n"
+		);
+
+	for( int i = 1; i < argc; i++ )
 	{
-		sequences.push_back( temp );
+		string opt( argv[i] );
+
+		// set the number of alignment threads
+		if( opt == "-threads" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				threads = atoi( argv[i] );
+				if( threads < 0 )
+				{
+					error( argv[0], errormsg );
+				}
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// only align the candidates of the k-mer index
+		if( opt == "-index" )
+		{
+			indexed = true;
+			continue;
+		}
+
+		// set the length of the k-mers of the prefilter
+		if( opt == "-k" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				k = atoi( argv[i] );
+				if( k < 0 || k > KMERMAX )
+				{
+					error( argv[0], errormsg );
+				}
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// set the width of the band
+		if( opt == "-band" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				bandwidth = atoi( argv[i] );
+				if( bandwidth < 0 )
+				{
+					error( argv[0], errormsg );
+				}
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// set the X-drop value
+		if( opt == "-xdrop" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				xdrop = atof( argv[i] );
+				if( xdrop < 0 )
+				{
+					error( argv[0], errormsg );
+				}
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// keep the clustering in a state file
+		if( opt == "-state" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				statefile = argv[i];
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// align on a GPU
+		if( opt == "-gpu" )
+		{
+			gpu = true;
+			continue;
+		}
+
+		// print a help message
+		if( opt == "-h" || opt == "-help" )
+		{
+			cout	<< argv[0] << ": " << endl
+				<< usage << endl;
+			return 0;
+		}
+
+		error( argv[0], errormsg );
 	}
 
-	int n = static_cast<int> (sequences.size());
+	// the alignment parameters. Each alignment thread reuses a copy of d1
+	// as its score-only workspace
+	dynamic d1( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, DYNGAPXTND, DYNSIG,
+		DYNSCORE, xdrop );
+	if( ( indexed || bandwidth >= 0 ) && k == 0 )
+	{
+		k = KMERDEFAULT;
+	}
 
-	cout	<< "Number of sequences: " << n << "\n\n" << endl;
+	// in streaming mode, the sequences of the state file come first, and
+	// only the pairs involving the new ones are aligned
+	clusterstate state;
+	cacheword signature = clusterstate::signature( d1, bandwidth, k,
+		indexed );
+	if( !statefile.empty() && !state.load( statefile, signature, store ) )
+	{
+		error( argv[0], "ERROR: " + statefile + " is not a state file "
+			"for these parameters. Program terminated." );
+	}
+	int old = state.size();
 
-	edges.resize( n );
-	for( int i = 0; i < n; i++ )
+	// read the whole input at once (see fasta.h) into a store, and use views
+	// of its sequences (see seqstore.h)
+	fasta input;
+	if( !input.good() )
 	{
-		edges[i].resize( n );
+		error( argv[0], "ERROR: Input could not be read. Program terminated." );
 	}
+	input.read( store );
+	store.views( sequences );
+
+	int n = static_cast<int> (sequences.size());
+
+	cout	<< "Number of sequences: " << n;
+	if( !statefile.empty() )
+	{
+		cout	<< " (" << n - old << " new)";
+	}
+	cout	<< "\n\n" << endl;
 
 	start = time( NULL );
 
-	for( int i = 0; i < n; i++ )
+	// align all the pairs in parallel
+	allpairs engine( sequences, d1, threads );
+	engine.band( bandwidth );
+	kmers filter( k > 0 ? k : KMERDEFAULT );
+	if( k > 0 )
+	{
+		filter.build( sequences );
+		engine.filter( &filter );
+	}
+	device accelerator;
+	if( gpu )
+	{
+		if( accelerator.open() )
+		{
+			engine.offload( &accelerator );
+		}
+		else
+		{
+			cerr	<< argv[0] << ": no CUDA device, aligning on the "
+				"CPU." << endl;
+		}
+	}
+
+	// in index mode, only the candidate pairs are aligned
+	if( indexed )
 	{
-		for( int j = i+1; j < n; j++ )
+		kmerindex index( INDEXPOSTINGS, filter.threshold() );
+		index.build( filter );
+		vector< pair<int, int> > pairs( index.pairs() );
+		if( old > 0 )
 		{
-			dynamic d1( sequences[i], sequences[j], true );
-			if( d1.significant() )
+			vector< pair<int, int> > added;
+			for( int p = 0; p < static_cast<int>( pairs.size() ); p++ )
 			{
-				edges[i][j] = edges[j][i] = true;
+				if( pairs[p].second >= old )
+				{
+					added.push_back( pairs[p] );
+				}
 			}
+			pairs.swap( added );
 		}
+		engine.run( pairs );
+	}
+	else
+	{
+		engine.run( old );
 	}
 
+	// add the edges of the state file (both lists are sorted, and so is the
+	// merge)
+	vector< pair<int, int> > edges;
+	edges.reserve( state.edges().size() + engine.edges().size() );
+	merge( state.edges().begin(), state.edges().end(),
+		engine.edges().begin(), engine.edges().end(),
+		back_inserter( edges ) );
+
 	end = time( NULL );
 
 	int totalsecs = static_cast<int>( difftime( end, start ) );
 
-	vector<bool> nodes( n );
-
-	vector< list<int> > adjedges( n );
-
-	for( int i = 0; i < n; i++ )
+	if( !statefile.empty() && !state.save( statefile, signature, sequences,
+		edges ) )
 	{
-		for( int j = 0; j < n; j++ )
-		{
-			if( edges[i][j] )
-			{
-				adjedges[i].push_back( j );
-			}
-		}
+		error( argv[0], "ERROR: " + statefile + " could not be written. "
+			"Program terminated." );
 	}
 
+	// the graph of the clusters (see clusters.h), built straight from the
+	// significant pairs: they are sorted, so every sequence gets its
+	// neighbours in increasing order
+	clusters graph;
+	graph.build( n, edges );
+
 	float tempscore( 0 ), totscore( 0 );
 
 	for( int i = 0, j = 0; i < n; i++ )
 	{
-		if( !nodes[i] && adjedges[i].size() != 0 )
+		if( !graph.visited(i) && graph.degree(i) != 0 )
 		{
 			cout	<< "Cluster " << j << endl << " ";
-			tempscore = 0;
-			tempscore = traversecluster( nodes, adjedges, i );
+			tempscore = graph.traverse( i );
+			for( int m = 0; m < tempscore; m++ )
+			{
+				cout	<< graph.members()[m] << " ";
+			}
 			cout	<< endl;
 			totscore += ( tempscore-1 ) * ( tempscore-1 );
 			j++;
@@ -87,34 +329,27 @@ int main( void )
 	cout	<< "Singletons: " << endl;
 	for( int i = 0; i < n; i++ )
 	{
-		if( !nodes[i] )
+		if( !graph.visited(i) )
 		{
 			cout	<< i << " ";
 		}
 	}
 	cout	<< "\n\n SCORE: " << totscore << endl
 		<< " TIME: " << totalsecs << endl
-		<< " ALIGNMENTS: " << n*(n-1)/2 << endl;
+		<< " ALIGNMENTS: " << static_cast<long>( engine.alignments() )
+		<< endl;
+	if( gpu )
+	{
+		cout	<< " DEVICE: " << accelerator.name() << " ("
+			<< static_cast<long>( engine.offloaded() )
+			<< " alignments)" << endl;
+	}
 
 	return 0;
 }
 
-int traversecluster( vector<bool>& nodes, vector< list<int> >& adjedges, int i )
+void error( const string& progname, const string& errormsg )
 {
-	if( nodes[i] )
-	{
-		return 0;
-	}
-
-	cout	<< i << " ";
-
-	int count = 1;
-	nodes[i] = true;
-
-	for( list<int>::iterator pos( adjedges[i].begin() );
-		pos != adjedges[i].end(); pos++ )
-	{
-		count += traversecluster( nodes, adjedges, *pos );
-	}
-	return count;
+	cerr	<< progname << ": " << errormsg << endl;
+	exit( EXIT_FAILURE );
 }
@@ -0,0 +1,341 @@
+	/*
+File:		fasta.cpp
+Title:		Class definitions for class "fasta" (declared in fasta.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "dna.h"
+#include "seqstore.h"
+#include "fasta.h"
+
+const size_t FASTACHUNK = 1 << 16;	// bytes read at a time from a pipe
+
+/******************************************************************************/
+
+// constructor for class fasta: map the file, or read it if it can not be mapped
+
+fasta::fasta( const string& file )
+	:
+	data_( 0 ),
+	size_( 0 ),
+	mapped_( false ),
+	good_( false )
+{
+	// the nucleotide code of every character, lowercase included
+	for( int c = 0; c < 256; c++ )
+	{
+		table_[c] = ( c < DNAASCII ) ?
+			dna::valid( static_cast<char>( toupper( c ) ) ) : X;
+	}
+
+	int fd = file.empty() ? 0 : open( file.c_str(), O_RDONLY );
+	if( fd < 0 )
+	{
+		return;
+	}
+
+	struct stat st;
+	if( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0 )
+	{
+		void* p = mmap( 0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		if( p != MAP_FAILED )
+		{
+			data_ = static_cast<const char*>( p );
+			size_ = st.st_size;
+			mapped_ = true;
+			madvise( p, size_, MADV_SEQUENTIAL );
+		}
+	}
+	good_ = mapped_ || slurp( fd );
+
+	// the mapping stays valid once the file is closed
+	if( fd != 0 )
+	{
+		close( fd );
+	}
+}
+
+/******************************************************************************/
+
+// destructor for class fasta
+
+fasta::~fasta()
+{
+	if( mapped_ )
+	{
+		munmap( const_cast<char*>( data_ ), size_ );
+	}
+}
+
+/******************************************************************************/
+
+// read the whole of a file descriptor into the buffer. Returns false on a read
+//	error.
+
+bool fasta::slurp( int fd )
+{
+	size_t used = 0;
+
+	for( ; ; )
+	{
+		buffer_.resize( used + FASTACHUNK );
+		ssize_t got = ::read( fd, &buffer_[used], FASTACHUNK );
+		if( got < 0 && errno == EINTR )
+		{
+			continue;
+		}
+		if( got < 0 )
+		{
+			return false;
+		}
+		if( got == 0 )
+		{
+			break;
+		}
+		used += got;
+	}
+
+	buffer_.resize( used );
+	data_ = used ? &buffer_[0] : 0;
+	size_ = used;
+	return true;
+}
+
+/******************************************************************************/
+
+// the newline ending the line that contains p, or the end of the input
+
+const char* fasta::eol( const char* p ) const
+{
+	const char* end = data_ + size_;
+	const void* nl = memchr( p, '\n', end - p );
+	return nl ? static_cast<const char*>( nl ) : end;
+}
+
+/******************************************************************************/
+
+// the number of lines starting with '>' from p on, up to stop if it is given (an
+//	upper bound of the number of records, as a name can take several lines)
+
+int fasta::count( const char* p, const char* stop ) const
+{
+	const char* end = stop ? stop : data_ + size_;
+	int lines = 1;
+
+	for( const char* q = p; ( q = static_cast<const char*>
+		( memchr( q, '\n', end - q ) ) ) != 0; )
+	{
+		if( ++q < end && *q == '>' )
+		{
+			lines++;
+		}
+	}
+	return lines;
+}
+
+/******************************************************************************/
+
+// parse the record starting at p (on a '>'): the name is left in name_ and
+//	the nucleotide codes in codes_. Returns the number of codes, and moves
+//	p to the start of the next record.
+
+int fasta::next( const char*& p )
+{
+	const char* end = data_ + size_;
+
+	// the name, and the lines continuing it, i.e. those starting with '>'
+	name_.erase();
+	for( ; ; )
+	{
+		const char* e = eol( ++p );
+		name_.append( p, e );
+		p = ( e < end ) ? e + 1 : end;
+		if( p == end || *p != '>' )
+		{
+			break;
+		}
+		name_ += ' ';
+	}
+
+	// the sequence runs until the next line starting with '>'
+	const char* stop = p;
+	while( stop < end && *stop != '>' )
+	{
+		stop = eol( stop );
+		if( stop < end )
+		{
+			stop++;
+		}
+	}
+
+	// translate the nucleotides, dropping newlines and invalid characters
+	codes_.resize( stop - p + 1 );
+	int n = 0;
+	for( const char* c = p; c < stop; c++ )
+	{
+		unsigned char code = table_[ static_cast<unsigned char>( *c ) ];
+		if( code != X )
+		{
+			codes_[n++] = code;
+		}
+	}
+
+	p = stop;
+	return n;
+}
+
+/******************************************************************************/
+
+// the first record of the input, or 0 if there is none
+
+const char* fasta::first( void ) const
+{
+	return data_ ? static_cast<const char*>( memchr( data_, '>', size_ ) )
+		: 0;
+}
+
+/******************************************************************************/
+
+// the first record starting at or after an offset in the input (the end of the
+//	input if there is none). A line starting with '>' only starts a record
+//	if the line before it is not part of a name, i.e. does not start with
+//	'>' and does not hold the first '>' of the input.
+
+const char* fasta::start( size_t offset ) const
+{
+	const char* end = data_ + size_;
+	const char* p = first();
+	if( p == 0 )
+	{
+		return end;
+	}
+	if( data_ + offset <= p )
+	{
+		return p;
+	}
+
+	// the first line starting at or after the offset
+	const char* q = data_ + offset;
+	if( q[-1] != '\n' )
+	{
+		q = eol( q );
+		q = ( q < end ) ? q + 1 : end;
+	}
+
+	for( ; q < end; )
+	{
+		if( *q == '>' )
+		{
+			// the start of the line before
+			const char* b = q - 1;
+			while( b > data_ && b[-1] != '\n' )
+			{
+				b--;
+			}
+			if( *b != '>' && !( b <= p && p < q ) )
+			{
+				return q;
+			}
+		}
+		q = eol( q );
+		q = ( q < end ) ? q + 1 : end;
+	}
+	return end;
+}
+
+/******************************************************************************/
+
+// append all the records of the input to a vector of sequences. Returns the
+//	number of records read.
+
+int fasta::read( vector<dna>& s )
+{
+	const char* p = first();
+	if( p == 0 )
+	{
+		return 0;
+	}
+
+	// the vector is only allocated once, so that no dna object is
+	// copied while it grows
+	s.reserve( s.size() + count( p ) );
+
+	const char* end = data_ + size_;
+	int records = 0;
+	while( p < end )
+	{
+		int n = next( p );
+		s.push_back( dna() );
+		s.back().name( name_ );
+		s.back().sequence( &codes_[0], n );
+		records++;
+	}
+	return records;
+}
+
+/******************************************************************************/
+
+// append all the records of the input to a sequence store. Returns the number
+//	of records read.
+
+int fasta::read( seqstore& s )
+{
+	const char* p = first();
+	if( p == 0 )
+	{
+		return 0;
+	}
+
+	// the input is an upper bound of the nucleotides
+	s.reserve( count( p ), static_cast<double>( size_ ) );
+
+	const char* end = data_ + size_;
+	int records = 0;
+	while( p < end )
+	{
+		int n = next( p );
+		s.add( name_, &codes_[0], n );
+		records++;
+	}
+	return records;
+}
+
+/******************************************************************************/
+
+// append the records of one of a number of shards of the input to a sequence
+//	store: those starting in its range of bytes. Returns their number.
+
+int fasta::read( seqstore& s, int shard, int shards )
+{
+	double size = static_cast<double>( size_ );
+	const char* p = start( static_cast<size_t>( size * shard / shards ) );
+	const char* stop = ( shard + 1 < shards ) ? start( static_cast<size_t>
+		( size * ( shard + 1 ) / shards ) ) : data_ + size_;
+	if( p >= stop )
+	{
+		return 0;
+	}
+
+	// the shard is an upper bound of its nucleotides
+	s.reserve( count( p, stop ), static_cast<double>( stop - p ) );
+
+	int records = 0;
+	while( p < stop )
+	{
+		int n = next( p );
+		s.add( name_, &codes_[0], n );
+		records++;
+	}
+	return records;
+}
@@ -0,0 +1,113 @@
+	/*
+File:		fasta.h
+Title:		Class declaration for class "fasta", a memory-mapped reader of
+		FASTA files.
+
+Description:
+
+1. OVERVIEW
+
+	operator>> of class dna (see dna.h) reads a FASTA record one character
+at a time from a stream, and every record is then copied into the vector of
+sequences. The fasta class reads a whole file at once instead: the file is
+mapped into memory, the records are found by scanning for newlines and '>'
+signals with memchr() (which the C library vectorizes), and the nucleotides of
+each record are translated with a lookup table and packed straight into their
+dna object, in a vector sized for all the records beforehand.
+
+	The format accepted is that of operator>>: a record starts with a '>' at
+the beginning of a line (or the first '>' of the file), the rest of the line is
+the name, and a name may continue on consecutive lines starting with '>'
+(joined by a space). The sequence runs until the next line starting with '>'.
+Invalid characters are discarded and lowercase is converted to uppercase.
+
+2. DATA MEMBERS
+
+	The contents of the file are either mapped (data points into the
+mapping), or, if the input can not be mapped (e.g. a pipe), read into a
+buffer. The name and codes buffers hold the name and the nucleotide codes of
+the record being read, and the table maps every character to its nucleotide
+code (X if invalid).
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR, DESTRUCTOR
+
+	The constructor opens and maps the named file, or the standard input if
+the name is empty. The destructor unmaps it.
+
+	3.2. OTHER FUNCTIONS
+
+		- good(): whether the input could be opened.
+		- read(): appends all the records of the input to a vector of
+	sequences, or to a sequence store (see seqstore.h), and returns their
+	number. Given a shard number and a number of shards, only the records
+	of that shard are appended to the store: the input is cut into that
+	many equal ranges of bytes, and a shard has the records that start in
+	its range, so every record is in exactly one shard (see mpiest.cpp).
+		- bytes(): the size of the input.
+
+4. NOTES
+
+	read() gives the same names and sequences as repeated calls to
+operator>>, in a fraction of the time.
+
+	*/
+
+#ifndef FASTA_H
+#define FASTA_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "dna.h"
+#include "seqstore.h"
+
+class fasta
+{
+	public:
+		// constructor, destructor
+		fasta( const string& file = "" );
+		~fasta();
+
+		// "get" functions
+		bool good( void ) const { return good_; }
+		double bytes( void ) const { return static_cast<double>( size_ ); }
+
+		// other functions
+		int read( vector<dna>& );
+		int read( seqstore& );
+		int read( seqstore&, int, int );
+
+	private:
+		// read the whole of a file descriptor into the buffer
+		bool slurp( int );
+
+		// the end of the line starting at p
+		const char* eol( const char* p ) const;
+
+		// the first record, the first one from an offset on, the
+		// number of records from p on (at most), and the parsing of
+		// the record at p
+		const char* first( void ) const;
+		const char* start( size_t ) const;
+		int count( const char* p, const char* stop = 0 ) const;
+		int next( const char*& p );
+
+		// no copying
+		fasta( const fasta& );
+		fasta& operator=( const fasta& );
+
+		const char* data_;	// the contents of the input
+		size_t size_;		// and their size
+		bool mapped_;		// is data_ a mapping (or the buffer)?
+		bool good_;		// could the input be opened?
+
+		vector<char> buffer_;	// the input, if it could not be mapped
+		string name_;			// the name of a record
+		vector<unsigned char> codes_;	// and its codes
+
+		unsigned char table_[256];	// the code of every character
+};
+
+#endif
@@ -11,13 +11,14 @@ Description:	This program makes use of MIT's GAlib (the Genetic Algorithm
 
 		See end of this file for implementation details.
 
-		Modules needed: dna.h, dna.cpp, dynamic.h, dynamic.cpp. GAlib
+		Modules needed: dna.h, dna.cpp, dynamic.h, dynamic.cpp,
+		striped.h, striped.cpp, allpairs.h, allpairs.cpp, cache.h,
+		cache.cpp, kmer.h, kmer.cpp, kmerindex.h, kmerindex.cpp,
+		fasta.h, fasta.cpp, seqstore.h, seqstore.cpp, diskcache.h,
+		diskcache.cpp, clustergenome.h, clustergenome.cpp, clusters.h,
+		clusters.cpp, profile.h, profile.cpp. GAlib and POSIX threads
 		must be installed.
 
-		NOTE: The hash table implementation is provided in <hash_map>,
-		which is not currently part of the C++ STL. It is expected to
-		be included in the next version though.
-
 	*/
 
 /******************************************************************************/
@@ -28,19 +29,33 @@ Description:	This program makes use of MIT's GAlib (the Genetic Algorithm
 #include <fstream>
 #include <vector>
 #include <string>
-#include <list>
-#include <hash_map>
 #include <cstdlib>
 #include <cmath>
 #include <ctime>
+#include <utility>
+#include <algorithm>
+#include <pthread.h>
 #include <ga/ga.h>
 #include "dna.h"
 #include "dynamic.h"
+#include "seqstore.h"
+#include "diskcache.h"
+#include "fasta.h"
+#include "allpairs.h"
+#include "cache.h"
+#include "kmer.h"
+#include "kmerindex.h"
+#include "clustergenome.h"
+#include "clusters.h"
+#include "profile.h"
 
 // default values for some program parameters
-const float LOAD = 0.5;
 const char* PARAMFILE = "gaparam.in";
-const int MAXSIZE = 1000;
+const float EXPLORE = 0.1;	// probability of choosing a random partner
+				// rather than a candidate of the index
+const int NEIGHBOURTRIES = 4;	// neighbours tried by a local mutation
+const int ISLANDS = 1;		// the number of GA populations (see F. below)
+const int MIGRATION = 10;	// the generations between two migrations
 
 /******************************************************************************/
 
@@ -53,30 +68,78 @@ template class GA1DArrayGenome<int>;
 float objective( GAGenome& );
 void initializer( GAGenome& );
 int mutator( GAGenome&, float );
+void evaluator( GAPopulation& );
 
 // declaration of "helper" functions
 
-int traversecluster( vector<bool>&, vector< list<int> >&, int,
-	bool print = false, ostream& output = cout, bool namesonly = false );
+void printcluster( const vector<int>&, ostream&, bool );
 void error( const string&, const string& );
 void check( int, int );
+int partner( int );
+int neighbour( const clustergenome&, int );
+bool edge( int, int );
+double measured( void );
+void* evaluate( void* );
+int fittest( const vector<GASimpleGA*>& );
+void migrate( vector<GASimpleGA*>& );
 void printtime( double, ostream& );
 
-// declaration of global vector<> of dna sequences and a 2D vector (the 2nd
-// dimension is a hash table to keep space usage down) containing all
-// previously determined edges
+// declaration of global vector<> of dna sequences, views of a store keeping
+// them all in a few arrays (see seqstore.h), and a cache (see cache.h)
+// containing all previously determined edges
+seqstore store;
 vector<dna> sequences;
-vector< hash_map<int, bool> > scores;
+cache scores;
 
 // declaration of global variables for trace statistics
 bool trace = false;
 string tracefilename = "gaesttrace.out";
 ofstream tracefile;
 double numaligned = 0;
-double expected = 0;
 time_t start, end;
 double timediff;
 
+// the timers and counters of the phases of the run (see profile.h), written to
+// a CSV file with -profile
+profile profiler;
+
+// declaration of global variables for parallel evaluation (see C. below). If
+// engine is set, check() only records the pairs to align in pending, and
+// evaluator() aligns them with the engine's threads before evaluating the
+// population
+allpairs* engine = 0;
+vector< pair<int, int> > pending;
+
+// the k-mer prefilter (see kmer.h), if any. check() stores the pairs it
+// rejects as not significant without aligning them
+kmers* filter = 0;
+
+// the width of the band around the diagonal of the shared k-mers, and the
+// X-drop value of the alignments (see dynamic.h), both off by default
+int bandwidth = DYNNOBAND;
+float xdrop = DYNNOXDROP;
+
+// the inverted k-mer index (see kmerindex.h), if any. The initializer and the
+// mutator then mostly choose the partner of a sequence among its candidates
+kmerindex* neighbours = 0;
+
+// the probability of choosing any partner rather than a candidate of the index,
+// or rather than a neighbour of the current partner in a local mutation, and
+// whether the mutator makes local mutations (see G. below)
+float explore = EXPLORE;
+bool nearby = false;
+
+// the results kept on disk by previous runs (see diskcache.h), if any. Pairs
+// found there are not aligned, and the new results are appended to it
+diskcache* archive = 0;
+
+// the state shared by the threads evaluating a population
+struct evaluation
+{
+	GAPopulation* pop_;	// the population being evaluated
+	int next_;		// the next individual to evaluate
+};
+
 /******************************************************************************/
 
 // main program
@@ -93,10 +156,15 @@ int main( int argc, char** argv )
 	}
 
 	// variables that can be modified through the command-line
-	float hashload = LOAD;
-	int maxsize = MAXSIZE;
+	int memory = 0;
 	string infile, outfile, paramfile, statsfile;
 	bool namesonly = false, stats = false;
+	int threads = 0;
+	int k = 0;
+	bool indexed = false;
+	string cachefile;
+	int nislands = ISLANDS;
+	int migration = MIGRATION;
 
 	// Strings containing error and help messages
 	const string errormsg( "Incorrect option syntax. Use -h for help." );
@@ -104,10 +172,9 @@ int main( int argc, char** argv )
 		"stdin in FASTA format, clusters\nthem by similarity and prints"
 		" them in clusters to stdout.\n\n"
 		"Available options:\n"
-		"\t-l(oad) float:\tspecify the expected load of hash tables.\n"
-			"\t\t\tfloat must be > 0. Low values use more memory\n"
-			"\t\t\tbut they are faster, and vice-versa.\n"
-		"\t-s(ize) int:\tspecify the maximum size of the hash tables.\n"
+		"\t-memory int:\tlimit the cache to about int megabytes,\n"
+			"\t\t\trealigning the pairs it forgets when they are\n"
+			"\t\t\tneeded again. 0 (default) sets no limit.\n"
 		"\t-stats file:\tprint GA statistics to the specified file.\n"
 		"\t-i(nput) file:\tspecify a file from which to read in\n"
 			"\t\t\tsequences.\n"
@@ -116,7 +183,40 @@ int main( int argc, char** argv )
 		"\t-p(arams) file:\tspecify the file from which the GA\n"
 			"\t\t\tparameters should be input.\n"
 		"\t-n(ames):\tonly output sequence names.\n"
+		"\t-threads int:\tspecify the number of alignment and\n"
+			"\t\t\tevaluation threads. 0 (default) uses one\n"
+			"\t\t\tper processor, 1 evaluates serially.\n"
+		"\t-k int:\t\tonly align the pairs sharing enough k-mers\n"
+			"\t\t\tof length int (at most 16). 0 (default)\n"
+			"\t\t\taligns all the pairs.\n"
+		"\t-index:\t\tchoose the partners of the sequences mostly\n"
+			"\t\t\tamong those sharing k-mers with them (implies\n"
+			"\t\t\t-k 11 if -k is not given).\n"
+		"\t-explore float:\tmutate the genes mostly towards the\n"
+			"\t\t\tneighbours of their partners, which are often\n"
+			"\t\t\taligned already, and otherwise to any partner\n"
+			"\t\t\twith probability float (also that of any\n"
+			"\t\t\tpartner with -index, 0.1 by default).\n"
+		"\t-band int:\tonly align the pairs in a band of width int\n"
+			"\t\t\taround the diagonal of their shared k-mers\n"
+			"\t\t\t(implies -k 11 if -k is not given).\n"
+		"\t-xdrop float:\tabandon the alignments that can no longer\n"
+			"\t\t\tbecome significant, allowing a slack of\n"
+			"\t\t\tfloat (0 is exact, larger values are faster).\n"
+		"\t-cache file:\tkeep the results of the alignments in a file,\n"
+			"\t\t\tand reuse those of previous runs (with the\n"
+			"\t\t\tsame alignment parameters).\n"
+		"\t-islands int:\tspecify the number of GA populations, which\n"
+			"\t\t\tevolve separately and exchange their best\n"
+			"\t\t\tindividuals. 0 uses one per thread, 1\n"
+			"\t\t\t(default) a single population.\n"
+		"\t-migrate int:\tspecify the number of generations between\n"
+			"\t\t\ttwo exchanges of the islands (default 10).\n"
 		"\t-t(race) file:\tprint trace statistics to a file.\n"
+		"\t-profile file:\tprint the time of every phase and the counts\n"
+			"\t\t\tof the cache and of the alignments, for the\n"
+			"\t\t\tinput, every generation and the output, to\n"
+			"\t\t\ta CSV file.\n"
 		"\t-h(elp):\tyou probably know this one already... ;-)\n"
 		);
 
@@ -126,14 +226,14 @@ int main( int argc, char** argv )
 	{
 		string opt( arguments[i] );
 
-		// change the load as specified on the command line
-		if( opt == "-l" || opt == "-load" )
+		// set the memory budget of the cache, in megabytes
+		if( opt == "-memory" )
 		{
 			if( i+1 < argc )
 			{
 				i++;
-				hashload = atof( arguments[i].c_str() );
-				if( hashload <= 0 )
+				memory = atoi( arguments[i].c_str() );
+				if( memory < 0 )
 				{
 					error( arguments[0], errormsg );
 				}
@@ -161,21 +261,6 @@ int main( int argc, char** argv )
 			continue;
 		}
 
-		// set the hash table maximum size to the specified size
-		if( opt == "-s" || opt == "-size" )
-		{
-			if( i+1 < argc )
-			{
-				i++;
-				maxsize = atoi( arguments[i].c_str() );
-			}
-			else
-			{
-				error( arguments[0], errormsg );
-			}
-			continue;
-		}
-
 		// set the file from which to read input
 		if( opt == "-i" || opt == "-input" )
 		{
@@ -228,6 +313,162 @@ int main( int argc, char** argv )
 			continue;
 		}
 
+		// set the number of threads
+		if( opt == "-threads" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				threads = atoi( arguments[i].c_str() );
+				if( threads < 0 )
+				{
+					error( arguments[0], errormsg );
+				}
+			}
+			else
+			{
+				error( arguments[0], errormsg );
+			}
+			continue;
+		}
+
+		// choose partners with the k-mer index
+		if( opt == "-index" )
+		{
+			indexed = true;
+			continue;
+		}
+
+		// set the length of the k-mers of the prefilter
+		if( opt == "-k" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				k = atoi( arguments[i].c_str() );
+				if( k < 0 || k > KMERMAX )
+				{
+					error( arguments[0], errormsg );
+				}
+			}
+			else
+			{
+				error( arguments[0], errormsg );
+			}
+			continue;
+		}
+
+		// make local mutations, with the specified exploration rate
+		if( opt == "-explore" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				nearby = true;
+				explore = atof( arguments[i].c_str() );
+				if( explore < 0 || explore > 1 )
+				{
+					error( arguments[0], errormsg );
+				}
+			}
+			else
+			{
+				error( arguments[0], errormsg );
+			}
+			continue;
+		}
+
+		// set the width of the band
+		if( opt == "-band" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				bandwidth = atoi( arguments[i].c_str() );
+				if( bandwidth < 0 )
+				{
+					error( arguments[0], errormsg );
+				}
+			}
+			else
+			{
+				error( arguments[0], errormsg );
+			}
+			continue;
+		}
+
+		// keep the alignment results in a file
+		if( opt == "-cache" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				cachefile = arguments[i];
+			}
+			else
+			{
+				error( arguments[0], errormsg );
+			}
+			continue;
+		}
+
+		// set the number of islands
+		if( opt == "-islands" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				nislands = atoi( arguments[i].c_str() );
+				if( nislands < 0 )
+				{
+					error( arguments[0], errormsg );
+				}
+			}
+			else
+			{
+				error( arguments[0], errormsg );
+			}
+			continue;
+		}
+
+		// set the number of generations between two migrations
+		if( opt == "-migrate" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				migration = atoi( arguments[i].c_str() );
+				if( migration < 1 )
+				{
+					error( arguments[0], errormsg );
+				}
+			}
+			else
+			{
+				error( arguments[0], errormsg );
+			}
+			continue;
+		}
+
+		// set the X-drop value
+		if( opt == "-xdrop" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				xdrop = atof( arguments[i].c_str() );
+				if( xdrop < 0 )
+				{
+					error( arguments[0], errormsg );
+				}
+			}
+			else
+			{
+				error( arguments[0], errormsg );
+			}
+			continue;
+		}
+
 		// print trace statistics. If no file is specified a default
 		// file will be created OR replaced.
 		if( opt == "-t" || opt == "-trace" )
@@ -255,6 +496,25 @@ int main( int argc, char** argv )
 			continue;
 		}
 
+		// profile the run into the specified file
+		if( opt == "-profile" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				if( !profiler.open( arguments[i] ) )
+				{
+					error( arguments[0], "Could not open "
+						"profile file." );
+				}
+			}
+			else
+			{
+				error( arguments[0], errormsg );
+			}
+			continue;
+		}
+
 		// print a help message
 		if( opt == "-h" || opt == "-help" )
 		{
@@ -269,109 +529,144 @@ int main( int argc, char** argv )
 		}
 	}
 
-	// initialize a dna "buffer" variable for input
-	dna temp;
+	// read in the sequences from file (if specified) or cin (default),
+	// mapping the file into memory (see fasta.h), and packing them into the
+	// store
+	double clock = profile::now();
+	fasta inputfile( infile );
+	if( !inputfile.good() )
+	{
+		error( arguments[0], "ERROR: Input file could not be "
+			"opened. Program terminated." );
+	}
+	inputfile.read( store );
+	store.views( sequences );
+	profiler.add( PROFINPUT, profile::now() - clock );
+	profiler.row( "input", 0 );
+
+	// create n to represent the number of sequences, for clutter-free code
+	int n = static_cast<int> (sequences.size());
 
-	// read in the sequences from file (if specified) or cin (default)
-	if( infile.size() == 0 )
+	if( trace )
 	{
-		while( cin >> temp )
-		{
-			sequences.push_back( temp );
-		}
+		tracefile << "Number of sequences:\t\t" << n << endl;
 	}
-	else
+
+	// with more than one thread, the alignments and the evaluation of the
+	// population are performed in parallel (see C. below)
+	dynamic proto( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, DYNGAPXTND, DYNSIG,
+		DYNSCORE, xdrop );
+	allpairs aligner( sequences, proto, threads );
+	aligner.band( bandwidth );
+	if( aligner.threads() > 1 )
 	{
-		ifstream inputfile( infile.c_str(), ios::nocreate | ios::in );
-		if( !inputfile.good() )
+		engine = &aligner;
+	}
+
+	// build the k-mer lists of the prefilter, and the index (the band
+	// needs the k-mers too)
+	if( ( indexed || bandwidth >= 0 ) && k == 0 )
+	{
+		k = KMERDEFAULT;
+	}
+	kmers sketches( k > 0 ? k : KMERDEFAULT );
+	kmerindex index( INDEXPOSTINGS, sketches.threshold() );
+	if( k > 0 )
+	{
+		sketches.build( sequences );
+		filter = &sketches;
+		aligner.filter( &sketches );
+		if( trace )
 		{
-			error( arguments[0], "ERROR: Input file could not be "
-				"opened. Program terminated." );
+			tracefile << "K-mer prefilter:\t\tk = " << k
+				<< ", threshold = " << sketches.threshold()
+				<< "\n" << endl;
 		}
-		while( inputfile >> temp )
+	}
+	if( indexed )
+	{
+		index.build( sketches );
+		neighbours = &index;
+		if( trace )
 		{
-			sequences.push_back( temp );
+			tracefile << "K-mer index:\t\t\t" << index.distinct()
+				<< " k-mers, " << index.postings()
+				<< " postings\n" << endl;
 		}
-		inputfile.close();
 	}
 
-	// create n to represent the number of sequences, for clutter-free code
-	int n = static_cast<int> (sequences.size());
-
-	if( trace )
+	// open the file of previous results, whose keys depend on the
+	// sequences and on the alignment parameters
+	diskcache results;
+	if( cachefile.size() )
 	{
-		tracefile << "Number of sequences:\t\t" << n << endl;
+		if( !results.open( cachefile, sequences,
+			diskcache::signature( proto, bandwidth, k ) ) )
+		{
+			error( arguments[0], "ERROR: Cache file could not be "
+				"opened. Program terminated." );
+		}
+		archive = &results;
+		if( trace )
+		{
+			tracefile << "Cache file:\t\t\t" << results.size()
+				<< " results\n" << endl;
+		}
 	}
 
-	// resize the first dimension of the scores table
-	scores.resize( n );
-
-	// initialize the genome
-	GA1DArrayGenome<int> genome( n, objective );
+	// initialize the genome, which keeps its clusters for the objective
+	// (see clustergenome.h)
+	clustergenome genome( n, objective, edge );
 	genome.initializer( ::initializer );
 	genome.mutator( ::mutator );
 
-	// initialize the GA
-	GASimpleGA ga( genome );
-
-	// set the GA parameters
+	// initialize the population and the GAs of the islands, which all share
+	// the cache (see F. below)
+	GAPopulation population( genome );
+	if( engine )
+	{
+		population.evaluator( ::evaluator );
+	}
+	if( nislands == 0 )
+	{
+		nislands = aligner.threads();
+	}
 	if( paramfile.size() == 0 )
 	{
 		paramfile = PARAMFILE;
 	}
-	ga.parameters( paramfile.c_str(), gaFalse );
+	vector<GASimpleGA*> islands( nislands );
+	for( int s = 0; s < nislands; s++ )
+	{
+		islands[s] = new GASimpleGA( population );
+		islands[s]->parameters( paramfile.c_str(), gaFalse );
+	}
+	GASimpleGA& ga = *islands[0];
 
-	// calculate the expected number of alignments to be computed.
-	// (dependent on genome size, population size, mutation rate, and
-	// number of generations). See description for derivation.
 	int popSize = ga.populationSize();
 	int nGen = ga.nGenerations();
 	float pMut = ga.pMutation();
-	double done( 0 );
 
 	if( trace )
 	{
-		tracefile << "Population size:\t\t" << popSize << endl
-			<< "Number of generations:\t\t" << nGen << endl
+		tracefile << "Population size:\t\t" << popSize << endl;
+		if( nislands > 1 )
+		{
+			tracefile << "Islands:\t\t\t" << nislands
+				<< ", migrating every " << migration
+				<< " generations" << endl;
+		}
+		tracefile << "Number of generations:\t\t" << nGen << endl
 			<< "Mutation rate:\t\t\t" << pMut << "\n" << endl;
 	}
 
-	// Round up total (expected) number of gene evaluations (SEE BELOW
-	// FOR DERIVATION)
-	int tot_gen_eval = static_cast<int>
-		(floor( n*popSize + n*popSize*nGen*pMut ) + 1 );
-
-	for( int i = 0; i < tot_gen_eval; i++ )
+	// the cache grows as the pairs are aligned, within the budget if any
+	// (see B. below)
+	scores.budget( memory * 1048576.0 );
+	if( trace && memory > 0 )
 	{
-		done = done + 2 - 2 * done/(n*(n-1));
-	}
-	expected = done;
-
-	// resize each scores[] hash table to have the specified load with the
-	// expected number of alignments, or to use less than the specified
-	// space (whichever is smaller)
-	int tablesize = static_cast<int> (done/n/hashload);
-	if( tablesize > n )
-	{
-		tablesize = n;
-	}
-	if( tablesize > maxsize )
-	{
-		tablesize = maxsize;
-	}
-
-	for( int i = 0; i < n; i++ )
-	{
-		scores[i].resize( tablesize );
-	}
-
-	if( trace )
-	{
-		tracefile << "Expected number of dynamic programming "
-			<< "alignments: " << done/2 << endl
-			<< "Calculated tablesize: " << tablesize << endl
-			<< "Real Tablesize: " << scores[0].bucket_count()
-			<< "\n" << endl;
+		tracefile << "Cache memory budget:\t\t" << memory << " MB\n"
+			<< endl;
 	}
 
 				// run the GA
@@ -382,7 +677,18 @@ int main( int argc, char** argv )
 		start = time(NULL);
 	}
 
-	ga.initialize();
+	// what is not timed otherwise in the initialization and in a
+	// generation are the genetic operators
+	clock = profile::now();
+	double timed = measured();
+	for( int s = 0; s < nislands; s++ )
+	{
+		islands[s]->initialize();
+	}
+	profiler.add( PROFOPERATORS, profile::now() - clock
+		- ( measured() - timed ) );
+	profiler.row( "initialize", islands[ fittest( islands ) ]
+		->statistics().bestIndividual().score() );
 
 	if( trace )
 	{
@@ -397,37 +703,72 @@ int main( int argc, char** argv )
 			timediff = difftime( end, start );
 			tracefile << i << "\t\t";
 			printtime( timediff, tracefile );
-			tracefile << "\t\t"
-				<< ga.statistics().bestIndividual().evaluate()
+			tracefile << "\t\t" << islands[ fittest( islands ) ]
+				->statistics().bestIndividual().evaluate()
 				<< endl;
 		}
-		ga.step();
+		clock = profile::now();
+		timed = measured();
+		for( int s = 0; s < nislands; s++ )
+		{
+			islands[s]->step();
+		}
+		if( ( i + 1 ) % migration == 0 )
+		{
+			migrate( islands );
+		}
+		profiler.add( PROFOPERATORS, profile::now() - clock
+			- ( measured() - timed ) );
+		profiler.row( i, islands[ fittest( islands ) ]
+			->statistics().bestIndividual().score() );
+	}
+
+	if( trace )
+	{
+		tracefile << "\nDynamic programming alignments:\t" << numaligned
+			<< endl
+			<< "Cache size:\t\t\t" << scores.size() << " entries in "
+			<< scores.capacity() << " slots (" << scores.bytes()
+			<< " bytes)" << endl
+			<< "Cache evictions:\t\t" << scores.evicted() << endl;
+	}
+
+	// write the new results to the cache file
+	if( archive )
+	{
+		archive->flush();
+		if( trace )
+		{
+			tracefile << "\nResults added to the cache file:\t"
+				<< archive->added() << endl;
+		}
 	}
 
-	// print the GA statistics
+	// print the GA statistics of the island holding the best individual
+	clock = profile::now();
+	GASimpleGA& winner = *islands[ fittest( islands ) ];
 	if( stats )
 	{
-		ga.statistics().write( statsfile.c_str() );
+		winner.statistics().write( statsfile.c_str() );
 	}
 
 	// print out the clustering of the best individual
 	const GA1DArrayGenome<int>& best =
 		static_cast< const GA1DArrayGenome<int>& >
-		( ga.statistics().bestIndividual() );
-
-	// first create a graph of the clusters (adjacency list representation)
-	vector<bool> nodes( n, false );
-	vector< list<int> > edges( n );
+		( winner.statistics().bestIndividual() );
 
+	// first create a graph of the clusters (see clusters.h)
+	vector< pair<int, int> > links;
 	for( int i = 0; i < n ; i++ )
 	{
 		int j = best.gene(i);
-		if( scores[i][j] )
+		if( edge( i, j ) )
 		{
-			edges[i].push_back(j);
-			edges[j].push_back(i);
+			links.push_back( pair<int, int>( i, j ) );
 		}
 	}
+	clusters graph;
+	graph.build( n, links );
 
 	// then print the sequences in clusters
 
@@ -472,11 +813,12 @@ int main( int argc, char** argv )
 		// first print sequences in clusters
 		for( int i = 0, j = 0; i < n; i++ )
 		{
-			if( !nodes[i] && edges[i].size() != 0 )
+			if( !graph.visited(i) && graph.degree(i) != 0 )
 			{
 				output	<< "Cluster " << j << endl;
 				j++;
-				traversecluster( nodes, edges, i, true, output,
+				graph.traverse( i );
+				printcluster( graph.members(), output,
 					namesonly );
 				output	<< endl;
 			}
@@ -486,7 +828,7 @@ int main( int argc, char** argv )
 		output	<< "Unclustered sequences:" << endl;
 		for( int i = 0; i < n; i++ )
 		{
-			if( !nodes[i] )
+			if( !graph.visited(i) )
 			{
 				output << " " << i << ": ";
 				if( namesonly )
@@ -508,19 +850,19 @@ int main( int argc, char** argv )
 	{
 		for( int i = 0, j = 0; i < n; i++ )
 		{
-			if( !nodes[i] )
+			if( !graph.visited(i) )
 			{
 				cout	<< "Cluster " << j;
 				j++;
-				traversecluster( nodes, edges, i, true, cout,
-					namesonly );
+				graph.traverse( i );
+				printcluster( graph.members(), cout, namesonly );
 				cout << endl;
 			}
 		}
 		cout	<< "Unclustered sequences: " << endl;
 		for( int i = 0; i < n; i++ )
 		{
-			if( !nodes[i] )
+			if( !graph.visited(i) )
 			{
 				cout	<< " " << i << ": ";
 				if( namesonly )
@@ -537,6 +879,13 @@ int main( int argc, char** argv )
 
 	tracefile.close();
 
+	profiler.add( PROFOUTPUT, profile::now() - clock );
+	profiler.row( "output", winner.statistics().bestIndividual().score() );
+
+	for( int s = 0; s < nislands; s++ )
+	{
+		delete islands[s];
+	}
 	return 0;
 }
 
@@ -544,51 +893,36 @@ int main( int argc, char** argv )
 
 float objective( GAGenome& g )
 {
-	GA1DArrayGenome<int>& genome = static_cast< GA1DArrayGenome<int>& > (g);
-	float total_score = 0;
-	vector<bool> nodes( genome.length(), false );
-	vector< list<int> > edges( genome.length() );
-
-	// first build the clusters
-	for( int i = 0; i < genome.length(); i++ )
-	{
-		int j = genome.gene(i);
-		if( scores[i][j] )
-		{
-			edges[i].push_back(j);
-			edges[j].push_back(i);
-		}
-	}
+	// the genome updates the clusters of the genes changed since its last
+	// evaluation, and sums the squares of their sizes minus one
+	clustergenome& genome = static_cast< clustergenome& > (g);
 
-	// then traverse each to determine their sizes
-	for( int i = 0; i < static_cast< int > ( nodes.size() ); i++ )
+	// in parallel mode, the evaluator times the evaluation as a whole
+	if( !profiler.active() || engine )
 	{
-		if( !nodes[i] )
-		{
-			int x = traversecluster( nodes, edges, i ) - 1;
-			total_score += static_cast< float >( x * x );
-		}
+		return genome.fitness();
 	}
-
-	return total_score;
+	double clock = profile::now();
+	float score = genome.fitness();
+	profiler.add( PROFOBJECTIVE, profile::now() - clock );
+	return score;
 }
 
 /******************************************************************************/
 
 void initializer( GAGenome& g )
 {
-	GA1DArrayGenome<int>& genome = static_cast< GA1DArrayGenome<int>& > (g);
+	clustergenome& genome = static_cast< clustergenome& > (g);
+
+	// all the genes change, so the clusters are rebuilt
+	genome.invalidate();
 
 	// initialize each gene in the GA genome
 	for( int i = 0; i < genome.length(); i++ )
 	{
-		// align to another sequence at random, but not to itself
-		int j = GARandomInt( 0, sequences.size()-1 );
-		while( i == j )
-		{
-			j = GARandomInt( 0, sequences.size()-1 );
-		}
-		genome.gene(i, j);
+		// align to another sequence, but not to itself
+		int j = partner( i );
+		genome.change(i, j);
 
 		// perform alignment only if they haven't been aligned before
 		check( i, j );
@@ -600,7 +934,7 @@ void initializer( GAGenome& g )
 
 int mutator( GAGenome& g, float rate )
 {
-	GA1DArrayGenome<int>& genome = static_cast< GA1DArrayGenome<int>& > (g);
+	clustergenome& genome = static_cast< clustergenome& > (g);
 
 	// the total number of mutations is the number of genes times pMut
 	int total_mutations = static_cast< int >
@@ -613,66 +947,401 @@ int mutator( GAGenome& g, float rate )
 		if( GAFlipCoin( rate * static_cast< float >(genome.length()) ) )
 		{
 			int i = GARandomInt( 0, genome.length()-1 );
-			int j = GARandomInt( 0, genome.length()-1 );
-			while( i == j )
+			int j = nearby ? neighbour( genome, i ) : partner( i );
+			if( j < 0 )
 			{
-				j = GARandomInt( 0, genome.length()-1 );
+				return 0;
 			}
 			check( i, j );
-			genome.gene(i, j);
+			genome.change(i, j);
 			return 1;
 		}
 		return 0;
 	}
 
 	// otherwise randomly mutate genes until the total number of mutations
-	// is reached
+	// is reached (local mutations without a neighbour are skipped)
+	int done = 0;
 	for( int c = 0; c < total_mutations; c++ )
 	{
 		int i = GARandomInt( 0, genome.length()-1 );
-		int j = GARandomInt( 0, genome.length()-1 );
-		while( i == j )
+		int j = nearby ? neighbour( genome, i ) : partner( i );
+		if( j < 0 )
 		{
-			j = GARandomInt( 0, genome.length()-1 );
+			continue;
 		}
 		check( i, j );
-		genome.gene(i, j);
+		genome.change(i, j);
+		done++;
+	}
+	return done;
+}
+
+/******************************************************************************/
+
+// choose the partner of a sequence in a gene: with the index, one of its
+//	candidates most of the time (see explore), otherwise any other sequence at
+//	random
+
+int partner( int i )
+{
+	if( neighbours && !neighbours->candidates(i).empty()
+		&& !GAFlipCoin( explore ) )
+	{
+		const vector<int>& c( neighbours->candidates(i) );
+		return c[ GARandomInt( 0, c.size()-1 ) ];
 	}
-	return total_mutations;
+
+	int j = GARandomInt( 0, sequences.size()-1 );
+	while( i == j )
+	{
+		j = GARandomInt( 0, sequences.size()-1 );
+	}
+	return j;
 }
 
 /******************************************************************************/
 
-// check whether two sequences have been aligned, and if not, align them
+// choose the new partner of a gene in a mutation with -explore (see G. below):
+//	any partner with probability explore, and otherwise, if its sequence i is
+//	in a cluster, a neighbour of the other members m (one of the candidates
+//	of m in the index, or else the partner of m), preferring one already
+//	known to be similar to i, then one not aligned with i yet. Returns -1 if
+//	there is no such neighbour, and the gene is then left as it is. In
+//	parallel mode the pairs pending alignment count as not aligned yet, so
+//	the choices differ from those of a single thread (see G. below).
+
+int neighbour( const clustergenome& genome, int i )
+{
+	if( GAFlipCoin( explore ) )
+	{
+		return partner( i );
+	}
+	int m = genome.mate(i);
+	if( m == i )
+	{
+		return -1;
+	}
+
+	int unknown = -1;
+	for( int t = 0; t < NEIGHBOURTRIES; t++, m = genome.mate(m) )
+	{
+		if( m == i )
+		{
+			m = genome.mate(m);
+		}
+		int q;
+		if( neighbours && !neighbours->candidates(m).empty() )
+		{
+			const vector<int>& c( neighbours->candidates(m) );
+			q = c[ GARandomInt( 0, c.size()-1 ) ];
+		}
+		else
+		{
+			q = genome.gene(m);
+		}
+		if( q == i )
+		{
+			continue;
+		}
+
+		// a pair in the cache needs no alignment, but is only worth it
+		// if it is an edge
+		if( !scores.known( i, q ) )
+		{
+			if( unknown < 0 )
+			{
+				unknown = q;
+			}
+		}
+		else if( edge( i, q ) )
+		{
+			return q;
+		}
+	}
+	return unknown;
+}
+
+/******************************************************************************/
+
+// check whether two sequences have been aligned, and if not, align them. Only
+//	the significance is needed, so the score-only alignment mode is used, and
+//	the same dynamic object is reused as a workspace for every alignment.
 
 void check( int i, int j )
 {
-	if( scores[i].find(j) == scores[i].end() )
+	static dynamic d1( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, DYNGAPXTND, DYNSIG,
+		DYNSCORE, xdrop );
+	int diagonal;
+
+	// the lookups, including those of the prefilter and of the cache file,
+	// and the alignment are timed separately when profiling
+	double clock = profiler.active() ? profile::now() : 0;
+	profiler.count( PROFLOOKUPS );
+
+	if( !scores.known( i, j ) )
+	{
+		// pairs sharing too few k-mers are not aligned
+		if( filter && !filter->pass( i, j ) )
+		{
+			scores.insert( i, j, false );
+			profiler.count( PROFFILTERED );
+			if( profiler.active() )
+			{
+				profiler.add( PROFCACHE, profile::now() - clock );
+			}
+			return;
+		}
+
+		// nor are the pairs aligned by a previous run
+		int stored = archive ? archive->find( i, j ) : CACHEMISS;
+		if( stored != CACHEMISS )
+		{
+			scores.insert( i, j, stored == CACHEYES );
+			profiler.count( PROFARCHIVED );
+			if( profiler.active() )
+			{
+				profiler.add( PROFCACHE, profile::now() - clock );
+			}
+			return;
+		}
+
+		// in parallel mode, leave the alignment to evaluator()
+		if( engine )
+		{
+			pending.push_back( pair<int, int>( min( i, j ),
+				max( i, j ) ) );
+			if( profiler.active() )
+			{
+				profiler.add( PROFCACHE, profile::now() - clock );
+			}
+			return;
+		}
+		if( profiler.active() )
+		{
+			double now = profile::now();
+			profiler.add( PROFCACHE, now - clock );
+			clock = now;
+		}
+
+		// center the band on the diagonal of the shared k-mers
+		if( bandwidth >= 0 && filter && filter->diagonal( i, j, diagonal ) )
+		{
+			d1.band( diagonal, bandwidth );
+		}
+		else
+		{
+			d1.unband();
+		}
+		d1.input( sequences[i], sequences[j], true );
+		numaligned++;
+		if( profiler.active() )
+		{
+			profiler.add( PROFALIGN, profile::now() - clock );
+			profiler.count( PROFALIGNED );
+			profiler.count( PROFSTOPPED, d1.stopped() );
+			profiler.count( PROFABANDONED, d1.abandoned() );
+			profiler.count( PROFCELLS, d1.cells() );
+		}
+		scores.insert( i, j, d1.significant() );
+		if( archive )
+		{
+			archive->insert( i, j, d1.significant() );
+		}
+		return;
+	}
+	profiler.count( PROFHITS );
+	if( profiler.active() )
 	{
-		dynamic d1( sequences[i], sequences[j], true );
-		scores[i][j] = scores[j][i] = d1.significant();
+		profiler.add( PROFCACHE, profile::now() - clock );
 	}
 	return;
 }
 
 /******************************************************************************/
 
-// traverse the sequence clusters using DFS graph traversal. The function
-//	returns the number of nodes traversed. If called without the fourth and
-//	fifth arguments, no output will be produced.
+// are two sequences significantly similar? The pair must have been checked
+//	before. The cache can be read by several threads at once.
+
+bool edge( int i, int j )
+{
+	return scores.edge( i, j );
+}
+
+/******************************************************************************/
+
+// the time of the phases timed within the GA since the last row of the profile,
+//	the rest of the time of a generation being that of the genetic operators
+
+double measured( void )
+{
+	return profiler.seconds( PROFALIGN ) + profiler.seconds( PROFCACHE )
+		+ profiler.seconds( PROFOBJECTIVE );
+}
+
+/******************************************************************************/
+
+// population evaluator for parallel mode: align the pairs recorded by check()
+//	since the last evaluation with the threads of the engine, store the
+//	results, and then evaluate the individuals in parallel.
 
-int traversecluster( vector<bool>& nodes, vector< list<int> >& edges, int i,
-	bool print, ostream& output, bool namesonly )
+void evaluator( GAPopulation& p )
 {
-	// if the node has already been visited, return
-	if( nodes[i] )
+	double clock = profiler.active() ? profile::now() : 0;
+	if( !pending.empty() )
 	{
-		return 0;
+		// check() records a pair each time it is asked for it, so the
+		// duplicates are removed once, before they are aligned, counted
+		// and written to the cache file
+		sort( pending.begin(), pending.end() );
+		pending.erase( unique( pending.begin(), pending.end() ),
+			pending.end() );
+		engine->run( pending );
+		numaligned += engine->alignments();
+		if( profiler.active() )
+		{
+			double now = profile::now();
+			profiler.add( PROFALIGN, now - clock );
+			clock = now;
+			profiler.count( PROFALIGNED, pending.size() );
+			profiler.count( PROFSTOPPED, engine->stopped() );
+			profiler.count( PROFABANDONED, engine->abandoned() );
+			profiler.count( PROFCELLS, engine->cells() );
+		}
+
+		// all the pending pairs are stored as not significant, and
+		// then the significant ones are set
+		for( vector< pair<int, int> >::const_iterator pos
+			= pending.begin(); pos != pending.end(); pos++ )
+		{
+			scores.insert( pos->first, pos->second, false );
+		}
+		for( vector< pair<int, int> >::const_iterator pos
+			= engine->edges().begin(); pos != engine->edges().end();
+			pos++ )
+		{
+			scores.insert( pos->first, pos->second, true );
+		}
+
+		// and on disk, with their results
+		if( archive )
+		{
+			for( vector< pair<int, int> >::const_iterator pos
+				= pending.begin(); pos != pending.end(); pos++ )
+			{
+				archive->insert( pos->first, pos->second,
+					scores.edge( pos->first, pos->second ) );
+			}
+			archive->flush();
+		}
+		pending.clear();
+		if( profiler.active() )
+		{
+			double now = profile::now();
+			profiler.add( PROFCACHE, now - clock );
+			clock = now;
+		}
+	}
+
+	// objective() only reads the tables (and updates the clusters of its
+	// own genome), so the individuals can be evaluated concurrently
+	evaluation e;
+	e.pop_ = &p;
+	e.next_ = 0;
+
+	vector<pthread_t> ids( engine->threads() );
+	for( int k = 1; k < engine->threads(); k++ )
+	{
+		if( pthread_create( &ids[k], NULL, evaluate, &e ) != 0 )
+		{
+			error( "gaest", "could not create evaluation thread." );
+		}
+	}
+	evaluate( &e );
+	for( int k = 1; k < engine->threads(); k++ )
+	{
+		pthread_join( ids[k], NULL );
+	}
+	if( profiler.active() )
+	{
+		profiler.add( PROFOBJECTIVE, profile::now() - clock );
+	}
+}
+
+/******************************************************************************/
+
+// evaluation thread: evaluate individuals until there are none left
+
+void* evaluate( void* arg )
+{
+	evaluation* e = static_cast<evaluation*>( arg );
+	int k;
+
+	while( ( k = __sync_fetch_and_add( &e->next_, 1 ) ) < e->pop_->size() )
+	{
+		e->pop_->individual( k ).evaluate();
 	}
+	return NULL;
+}
+
+/******************************************************************************/
+
+// the island whose best individual scores highest (the first of them on ties)
 
-	// print if an ostream is available
-	if( print )
+int fittest( const vector<GASimpleGA*>& islands )
+{
+	int f = 0;
+	for( int s = 1; s < static_cast<int>( islands.size() ); s++ )
 	{
+		if( islands[s]->statistics().bestIndividual().score()
+			> islands[f]->statistics().bestIndividual().score() )
+		{
+			f = s;
+		}
+	}
+	return f;
+}
+
+/******************************************************************************/
+
+// migration between the islands: a copy of the best individual of every island
+//	replaces the worst individual of the next one, around a ring. The
+//	migrants keep their clusters (see clustergenome.h), and their pairs are
+//	in the cache, so they need no alignment.
+
+void migrate( vector<GASimpleGA*>& islands )
+{
+	int n = static_cast<int>( islands.size() );
+	if( n < 2 )
+	{
+		return;
+	}
+
+	vector<GAGenome*> migrants( n );
+	for( int s = 0; s < n; s++ )
+	{
+		migrants[s] = islands[s]->statistics().bestIndividual().clone();
+	}
+	for( int s = 0; s < n; s++ )
+	{
+		GASimpleGA& next = *islands[ ( s + 1 ) % n ];
+		GAPopulation arrivals( next.population() );
+		delete arrivals.replace( migrants[s], GAPopulation::WORST );
+		next.population( arrivals );
+	}
+}
+
+/******************************************************************************/
+
+// print the members of a cluster, in the order of the traversal that found
+//	them (see clusters.h)
+
+void printcluster( const vector<int>& members, ostream& output,
+	bool namesonly )
+{
+	for( int m = 0; m < static_cast<int>( members.size() ); m++ )
+	{
+		int i = members[m];
 		output	<< " " << i << ": ";
 		if( namesonly )
 		{
@@ -684,21 +1353,6 @@ int traversecluster( vector<bool>& nodes, vector< list<int> >& edges, int i,
 			output	<< sequences[i] << endl;
 		}
 	}
-
-	// count the current node and mark as visited
-	int count( 1 );
-	nodes[i] = true;
-
-	// traverse the nodes accessible from this node
-	for( list<int>::iterator pos( edges[i].begin() );
-		pos != edges[i].end(); pos++ )
-	{
-		count += traversecluster( nodes, edges, *pos, print, output,
-			namesonly );
-	}
-
-	// return the number of traversed nodes
-	return count;
 }
 
 /******************************************************************************/
@@ -783,21 +1437,15 @@ A. General overview of the implementation of the GA and the formulation of the
 	alignment between sequences 20 and 6.
 
 		Whenever the result of an alignment is obtained, it is stored
-	in a 'vector' of hash tables ('hash_map') of size n, where each of the
-	tables is of size x * exp / n, where
-		x is an adjustment factor to control total space usage, and
-		exp is the expected number of alignments (see below for
-			derivation).
+	in a cache (see cache.h), an open-addressing hash table holding each
+	pair once, in 8 bytes. It starts small and grows as the pairs are
+	aligned (see B.).
 
 		If another gene is evaluated that needs the same result (e.g.
 	gene#6 with value 20), it can access it from the hash table. This is
 	preferred over having to perform the alignment again, which is quite
 	expensive (O(N*M), where N and M are the lengths of the sequences). By
-	contrast, even with a small hash table (which uses linear chaining),
-	the chain is unlikely to get as long as N*M, which would be around
-	90,000, as ESTs are about 300bp in length. Furthermore stepping through
-	a list is faster than calculating dynamic programming scores, and also
-	on average we will only need to search halfway through the list.
+	contrast, a lookup in the cache only probes a few consecutive slots.
 
 		The scoring function for the GA was initially to add the scores
 	of the alignments together. However this can have problems as two
@@ -816,92 +1464,163 @@ A. General overview of the implementation of the GA and the formulation of the
 		The final scoring function is therefore to look at cluster
 	size. The score increases geometrically with cluster size, so that a
 	large cluster scores much higher than two half-sized clusters.
-	
-
-B. Derivation of the expected number of dynamic programming alignments to be
-	computed.
-
-		Let 'exp' be the this number. 'exp' will depend on two numbers
-	(which are not independent):
-
-			1. n, the total number of DNA sequences to be clustered
-			2. t, the total number of GA genes to be evaluated
-
-		Keep in mind that a GA gene evaluation does not imply a new
-	alignment, as the results of previous alignments are kept in memory.
-
-		n will depend on input. t is the sum of:
-
-			1. the total number of genes evaluated in the first
-		generation. In the first generation every gene must be
-		evaluated, and the number of genes is the genes per genome
-		(i.e. the genome size, equal to n) multiplied by the number of
-		genomes (i.e. the population size, referred to hereafter as
-		popSize). Thus:
-
-				n * popSize
-
-			2. The total number of genes evaluated in subsequent
-		generations. In these generations only mutated genes need to be
-		evaluated. We can obtain an estimation of the number of genes
-		evaluated here by multiplying the total number of genes
-		considered by the mutation rate (pMut, or the probability that
-		a gene will be mutated). The total number of genes can be
-		obtained by mutiplying the genes per generation (calculated
-		above) by the number of generations (nGen). Thus:
-
-				pMut * nGen * n * popSize
-
-		Therefore the total number of evaluated genes t will be:
 
-			t = n * popSize + pMut * nGen * n * popSize
-			  = ( popSize + popSize * nGen * pMut ) * n
-
-		To obtain 'exp' we must take into account the probability that
-	a given gene being evaluated has not been evaluated before, which we
-	will call p(i) for the i'th gene evaluation. p(0) is 1, and then as
-	i increases p decreases to 0.
-
-		p(i) will depend on the number of alignments that have been
-	performed to that point. Let this number be referred to as done(i).
-
-		done(i) can be defined by a recursive relationship: done(i) is
-	done(i-1) added to twice the probability that a new alignment will have 
-	been performed, i.e. 2*p(i). (twice because each new alignment actually
-	gives the results for two alignments: the performed alignment and also
-	the reciprocal alignment) Thus:
-
-			done(0) = 0;
-			done(i) = done(i-1) + 2*p(i-1).
-
-		p(i) can then be expressed in terms of done(i) and the total
-	number of possible alignments. The probability of a new alignment being
-	performed is the number of alignments that have not been done divided
-	by the total number of possible alignments. Furthermore, the number of
-	alignments that have not been performed is equal to the total number
-	of possible alignments minus the number of alignments that *have* been
-	performed, i.e. done(i). Finally, the total number of possible
-	alignments is n*(n-1) (since a sequence will never be aligned to
-	itself). Thus:
-
-			p(i) = { n*(n-1) - done(i) } / (n*(n-1))
-			     = 1 - done(i) / (n*(n-1)).
-
-		Therefore:
-
-			done(0) = 0;
-			done(i) = done(i-1) + 2 - 2 * done(i-1) / (n*(n-1)).
-
-		And:
-
-			-->  exp = done(t) <--
-
-		So the expected number of alignments can now be calculated
-	using a simple recursive rule.
+		Each genome keeps its clusters between evaluations (see
+	clustergenome.h). The mutator records the genes it changes, and the
+	next evaluation only recomputes the clusters of those sequences and of
+	their new partners, so its cost depends on the mutations, not on n.
+	The clusters are rebuilt after the initializer and after crossover.
+	
 
-		Note that the number of dynamic alignments called will be half
-	this number since only half of the alignments will need to be perfor-
-	med.
+B. Cache memory
+
+		The program used to size the cache at the start for the number of
+	alignments expected from the population size, the mutation rate and
+	the number of generations, assuming random partners. The estimate no
+	longer holds with the prefilter, the index and the local mutations
+	(see D. and G.), so the cache (see cache.h) now starts small and
+	doubles its shards as they fill up, and the trace file gives its
+	actual size at the end of the run.
+
+		With -memory, the cache is kept within a budget, in megabytes:
+	the shards that reach their share of it evict the entries that have
+	not been looked up for the longest (a clock policy) instead of
+	growing. Only the pairs that are not significant are evicted, so the
+	clusters of the genomes never change (see clustergenome.h): a pair
+	evicted is only aligned again if a gene needs it. The significant pairs
+	are kept even beyond the budget, but they are a small part of the
+	pairs of an EST library. The trace file gives the number of entries
+	evicted.
+
+
+C. Parallel evaluation
+
+		With more than one thread (-threads), the alignments are not
+	performed by check() as soon as a gene needs them. Instead the
+	initializer and the mutator only record the pairs that are not in the
+	tables yet, and the population evaluator (called by GAlib once all the
+	individuals of a generation have been created) aligns all of them at
+	once with an allpairs engine (see allpairs.h). This keeps all the
+	processors busy, in particular in the first generation, where about
+	n * popSize pairs are needed.
+
+		The individuals are then evaluated concurrently: objective()
+	only reads the tables (see edge()), and each thread evaluates whole
+	individuals, taken in turn from a shared counter. The clustering found
+	is the same as with a single thread, as the random choices of the GA
+	are not affected, except with -explore (see G.).
+
+
+D. K-mer prefilter
+
+		With -k, the k-mers of every sequence are listed once after
+	input (see kmer.h), and check() stores the pairs that share too few
+	of them as not significant, without aligning them. Most pairs of an
+	EST library are unrelated, so most of the alignments are avoided.
+
+		With -index, an inverted index of the k-mers gives the ranked
+	candidate partners of every sequence (see kmerindex.h). The initializer
+	and the mutator choose a candidate as the partner of a gene, except
+	with probability EXPLORE (see -explore) and for the sequences without
+	candidates, when any sequence is chosen at random. Genes thus point
+	mostly at related sequences from the first generation on, instead of
+	at random ones.
+
+		The diagonal of the shared k-mers of a pair is also where its
+	alignment lies. With -band, only a band of cells around it is computed
+	(see dynamic.h), by check() and by the engine alike. With -xdrop, the
+	alignments that can no longer become significant are abandoned before
+	the end. Both make the alignments cheaper, at the risk of missing a few
+	significant ones.
+
+
+E. Cache file
+
+		With -cache, the results of the alignments are also appended to a
+	file (see diskcache.h), which later runs map into memory: check() then
+	takes the result of a pair from the file if it is there, and aligns it
+	otherwise. The file is keyed by the contents of the sequences and by the
+	alignment parameters, so one file serves runs with other GA parameters
+	(the usual reason to rerun gaest on the same ESTs) or on a changed set
+	of ESTs, and results computed with other alignment parameters are
+	ignored.
+
+
+F. Islands
+
+		A larger population finds better clusterings, but the result of
+	a single population of popSize individuals tends to converge on one of
+	them early. With -islands, the program instead evolves several
+	populations of popSize individuals (islands), each with its own GA,
+	and every MIGRATION generations (see -migrate) a copy of the best
+	individual of each island replaces the worst individual of the next
+	one, around a ring. The islands thus explore different clusterings,
+	and the best ones still spread among them slowly.
+
+		All the islands share the cache, so a pair aligned for one of them
+	is never aligned again for another, and a migrant needs no alignment at
+	all.
+
+		The genetic operators of GAlib and its random number generator are
+	not reentrant, so the islands step one after the other, each evaluated
+	with all the threads of the engine (see C.), rather than one island per
+	thread. The clustering printed is that of the best individual of all the
+	islands. With a single island (the default) the program runs exactly as
+	before.
+
+
+G. Local mutations
+
+		Most of the partners chosen at random by the mutator are unrelated
+	to their sequences, so nearly every mutation costs a new alignment, and
+	only a few of them join clusters. With -explore, the mutator rather
+	moves the gene of a sequence i of a cluster towards a neighbour of the
+	other members m of the cluster (see clustergenome.h, mate()): one of
+	the candidates of m in the index (with -index), or else the partner of
+	m. A sequence similar to a sequence similar to i is often similar to i
+	itself, and it is often in the cache already: among the neighbours of
+	NEIGHBOURTRIES members, the first one known to be similar to i is
+	chosen, which needs no alignment, and otherwise the first one not
+	aligned with i yet.
+
+		A fraction explore of the mutations still choose any partner (see
+	partner()), so that the GA keeps finding new clusters. The others are
+	skipped for the sequences alone in their clusters, which have no
+	neighbours, so that the alignments of a generation fall to about
+	explore times the number of mutations, plus the neighbours that were
+	not in the cache. The trace file gives the number of alignments
+	performed.
+
+		The choice of a neighbour depends on the results in the cache. In
+	parallel mode (see C.), the pairs checked earlier in the same
+	generation are still waiting for the evaluator, so they count as not
+	aligned yet, whereas with a single thread their results are already
+	known: with -explore, the runs with several threads therefore choose
+	other neighbours than with -threads 1, and find other clusterings.
+	Use -threads 1 to reproduce a run exactly.
+
+
+H. Profile
+
+		With -profile, the time of every phase of the run and the counts of
+	the cache and of the alignments are written to a CSV file (see
+	profile.h), in one row for the input, one for the initialization, one
+	per generation and one for the output. check() times its lookups (of
+	the cache, and of the prefilter and the cache file for the pairs not in
+	it) apart from the alignment, and in parallel mode the evaluator times
+	the alignments of the engine, the storing of their results and the
+	evaluation of the population. The other phases of a generation are only
+	timed as a whole: what is left once the alignments, the lookups and the
+	objective are taken out is the time of the genetic operators. The
+	alignments stopped early are those that reached significance before
+	their last cell (check() stops there), and those abandoned early the
+	ones that X-drop gave up on; the cells counted are those the alignments
+	computed (see dynamic.h), fewer than the whole matrices or bands when
+	they stopped or were abandoned.
+
+		A run that is slow because of its alignments thus shows most of its
+	time in the align column, and one that is slow because of the GA in the
+	objective and operators columns.
 
 									      */
 
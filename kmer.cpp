@@ -0,0 +1,201 @@
+	/*
+File:		kmer.cpp
+Title:		Class definitions for class "kmers" (declared in kmer.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include "dna.h"
+#include "kmer.h"
+
+/******************************************************************************/
+
+// constructor for class kmers
+
+kmers::kmers( int k, int sl )
+	:
+	k_( k < 1 ? 1 : ( k > KMERMAX ? KMERMAX : k ) ),
+	threshold_( minimum( k_, sl ) )
+{
+}
+
+/******************************************************************************/
+
+// the minimum number of shared k-mers of an alignment of sl columns with 5%
+//	errors (see kmer.h)
+
+int kmers::minimum( int k, int sl )
+{
+	int errors = static_cast<int>( floor( 0.05 * sl ) );
+	int t = sl + 1 - k * ( errors + 1 );
+	return t > 1 ? t : 1;
+}
+
+/******************************************************************************/
+
+// build the sorted k-mer lists of a set of sequences
+
+void kmers::build( const vector<dna>& s )
+{
+	int n = static_cast<int>( s.size() );
+	unsigned int mask = ( k_ == KMERMAX ) ? ~0U : ( ( 1U << ( 2*k_ ) ) - 1 );
+	vector<unsigned char> seq;
+	vector< pair<unsigned int, int> > found;
+
+	codes_.clear();
+	codes_.resize( n );
+	positions_.clear();
+	positions_.resize( n );
+
+	for( int i = 0; i < n; i++ )
+	{
+		int len = s[i].length();
+		seq.resize( len > 0 ? len : 1 );
+		s[i].unpack( &seq[0] );
+
+		found.clear();
+		found.reserve( len > k_ ? len - k_ + 1 : 0 );
+
+		// slide a window along the sequence. run is the number of
+		// unambiguous bases at the end of the window
+		unsigned int code = 0;
+		int run = 0;
+		for( int p = 0; p < len; p++ )
+		{
+			unsigned int base;
+			switch( seq[p] )
+			{
+				case A: base = 0; break;
+				case C: base = 1; break;
+				case G: base = 2; break;
+				case T: base = 3; break;
+				default:
+					run = 0;
+					continue;
+			}
+			code = ( ( code << 2 ) | base ) & mask;
+			if( ++run >= k_ )
+			{
+				found.push_back( pair<unsigned int, int>
+					( code, p + 1 - k_ ) );
+			}
+		}
+
+		// sort the k-mers by code, then by position
+		sort( found.begin(), found.end() );
+		codes_[i].resize( found.size() );
+		positions_[i].resize( found.size() );
+		for( int f = 0; f < static_cast<int>( found.size() ); f++ )
+		{
+			codes_[i][f] = found[f].first;
+			positions_[i][f] = found[f].second;
+		}
+	}
+}
+
+/******************************************************************************/
+
+// count the k-mers shared by two sequences (a k-mer found a times in one and
+//	b times in the other counts min(a, b) times). If stop is positive, the
+//	count stops as soon as it reaches stop.
+
+int kmers::shared( int i, int j, int stop ) const
+{
+	const vector<unsigned int>& x( codes_[i] ), & y( codes_[j] );
+	vector<unsigned int>::const_iterator px( x.begin() ), py( y.begin() );
+	int count = 0;
+
+	while( px != x.end() && py != y.end() )
+	{
+		if( *px < *py )
+		{
+			px++;
+		}
+		else if( *py < *px )
+		{
+			py++;
+		}
+		else
+		{
+			px++;
+			py++;
+			if( ++count == stop )
+			{
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+/******************************************************************************/
+
+// the diagonal (position in j minus position in i) holding the most k-mers
+//	shared by sequences i and j, the smallest such diagonal in case of a tie.
+//	Every pair of occurrences of a shared k-mer votes for its diagonal,
+//	except for the k-mers repeated more than KMERREPEAT times in either
+//	sequence. Returns false if no k-mer voted.
+
+bool kmers::diagonal( int i, int j, int& d ) const
+{
+	const vector<unsigned int>& x( codes_[i] ), & y( codes_[j] );
+	const vector<int>& px( positions_[i] ), & py( positions_[j] );
+	int nx = static_cast<int>( x.size() ), ny = static_cast<int>( y.size() );
+	vector<int> votes;
+
+	for( int a = 0, b = 0; a < nx && b < ny; )
+	{
+		if( x[a] < y[b] )
+		{
+			a++;
+		}
+		else if( y[b] < x[a] )
+		{
+			b++;
+		}
+		else
+		{
+			// the runs of the k-mer in both sequences
+			int ea, eb;
+			for( ea = a; ea < nx && x[ea] == x[a]; ea++ ) { ; }
+			for( eb = b; eb < ny && y[eb] == y[b]; eb++ ) { ; }
+
+			if( ea - a <= KMERREPEAT && eb - b <= KMERREPEAT )
+			{
+				for( int p = a; p < ea; p++ )
+				{
+					for( int q = b; q < eb; q++ )
+					{
+						votes.push_back( py[q] - px[p] );
+					}
+				}
+			}
+			a = ea;
+			b = eb;
+		}
+	}
+
+	if( votes.empty() )
+	{
+		return false;
+	}
+
+	// the most frequent diagonal is the longest run of the sorted votes
+	sort( votes.begin(), votes.end() );
+	int best = 0;
+	for( int b = 0, e = 0; b < static_cast<int>( votes.size() ); b = e )
+	{
+		for( e = b; e < static_cast<int>( votes.size() )
+			&& votes[e] == votes[b]; e++ ) { ; }
+		if( e - b > best )
+		{
+			best = e - b;
+			d = votes[b];
+		}
+	}
+	return true;
+}
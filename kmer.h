@@ -0,0 +1,132 @@
+	/*
+File:		kmer.h
+Title:		Class declaration for class "kmers", a k-mer prefilter for
+		pairs of dna sequences.
+
+Description:
+
+1. OVERVIEW
+
+	Most pairs of ESTs in a library are unrelated, and share almost no
+subsequences. The kmers class keeps, for every sequence of a set, the sorted
+list of its k-mers (its subsequences of length k), so that the number of
+k-mers two sequences have in common can be counted in time linear in their
+lengths. Pairs sharing fewer k-mers than a threshold are rejected without
+performing the dynamic programming alignment (see dynamic.h).
+
+2. DATA MEMBERS
+
+	2.1. K-MERS
+
+	A k-mer is encoded in 2 bits per base (A = 0, C = 1, G = 2, T = 3), so
+k can be at most KMERMAX. K-mers containing ambiguous nucleotides (e.g. N) are
+skipped. The codes of each sequence are sorted, and duplicates are kept, so
+the shared k-mers of two sequences are counted by merging their lists. The
+position of each k-mer in its sequence is kept alongside its code (k-mers with
+the same code are sorted by position).
+
+	2.2. DIAGONALS
+
+	Two k-mers shared by sequences x and y, at positions p in x and q in y,
+lie on the diagonal q - p of their alignment matrix (see dynamic.h). The
+diagonal holding the most shared k-mers is where the alignment of two related
+sequences is found, and where a banded alignment should be centered. K-mers
+found more than KMERREPEAT times in one of the sequences are ignored, since
+their spurious hits would swamp the true diagonal.
+
+	2.3. THRESHOLD
+
+	By default the threshold is the minimum number of shared k-mers of two
+sequences with a significant alignment of the minimal length (see DYNSIG in
+dynamic.h) with 5% of errors, the mismatches allowed by the significance test
+of dynamic. By the q-gram lemma, an alignment of L columns with e errors
+(mismatches or gaps) contains at least L + 1 - k*(e+1) k-mers found in both
+sequences. Thus, for L = DYNSIG and e = 0.05*DYNSIG, the threshold is:
+
+		DYNSIG + 1 - k * ( floor( 0.05*DYNSIG ) + 1 )
+
+and at least 1.
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR
+
+	The constructor takes the value of k and the minimal significant
+length, from which the threshold is calculated.
+
+	3.2. OTHER FUNCTIONS
+
+		- build(): builds the k-mer lists of a set of sequences. Must be
+	called before the other functions, and again if the sequences change.
+		- shared(): the number of k-mers shared by two sequences (by their
+	indices). If a stop value is given, counting stops when it is reached.
+		- pass(): whether two sequences share at least threshold()
+	k-mers, i.e. whether their alignment should be performed.
+		- diagonal(): the diagonal q - p holding the most k-mers shared by
+	sequences i (x) and j (y). Returns false if they share none.
+		- k(), threshold(): the value of k, and the threshold.
+		- codes(): the sorted k-mers of a sequence.
+		- size(): the number of sequences.
+		- threshold(): sets the threshold.
+		- minimum(): the default threshold for a value of k and a minimal
+	significant length.
+
+4. NOTES
+
+	The threshold guarantees that no significant alignment of DYNSIG
+columns with up to 5% errors is rejected. Longer alignments with more errors
+can reach the significance score with fewer shared k-mers, so the filter is
+not lossless in general. Smaller values of k reject fewer pairs, but they are
+also less likely to reject related ones.
+
+	All the "get" functions only read the lists, so after build() they can be
+called from several threads.
+
+	*/
+
+#ifndef KMER_H
+#define KMER_H
+
+#include <vector>
+#include "dna.h"
+#include "dynamic.h"
+
+const int KMERMAX = 16;		// largest k (the codes are 32-bit)
+const int KMERDEFAULT = 11;	// default value of k
+const int KMERREPEAT = 8;	// k-mers repeated more are left out of diagonal()
+
+class kmers
+{
+	public:
+		// constructor
+		kmers( int k = KMERDEFAULT, int sl = DYNSIG );
+
+		// "get" functions
+		int k( void ) const { return k_; }
+		int threshold( void ) const { return threshold_; }
+		int shared( int, int, int stop = 0 ) const;
+		bool pass( int i, int j ) const
+			{ return shared( i, j, threshold_ ) >= threshold_; }
+		bool diagonal( int, int, int& ) const;
+		const vector<unsigned int>& codes( int i ) const
+			{ return codes_[i]; }
+		int size( void ) const
+			{ return static_cast<int>( codes_.size() ); }
+		static int minimum( int, int );
+
+		// "set" functions
+		void threshold( int t ) { threshold_ = t; }
+
+		// other functions
+		void build( const vector<dna>& );
+
+	private:
+		int k_;			// the length of the k-mers
+		int threshold_;		// the minimum number of shared k-mers
+		vector< vector<unsigned int> > codes_;
+					// the sorted k-mers of each sequence
+		vector< vector<int> > positions_;
+					// and their positions
+};
+
+#endif
@@ -0,0 +1,180 @@
+	/*
+File:		kmerindex.cpp
+Title:		Class definitions for class "kmerindex" (declared in
+		kmerindex.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "kmer.h"
+#include "kmerindex.h"
+
+/******************************************************************************/
+
+// constructor for class kmerindex
+
+kmerindex::kmerindex( int mp, int ms, int mc )
+	:
+	maxpostings_( mp > 0 ? mp : INDEXPOSTINGS ),
+	minshared_( ms > 0 ? ms : 1 ),
+	maxcandidates_( mc )
+{
+}
+
+/******************************************************************************/
+
+// order of candidates: decreasing number of shared k-mers, then increasing
+//	index
+
+static bool ranked( const pair<int, int>& a, const pair<int, int>& b )
+{
+	return a.first > b.first || ( a.first == b.first && a.second < b.second );
+}
+
+/******************************************************************************/
+
+// build the index and the candidate lists
+
+void kmerindex::build( const kmers& km )
+{
+	int n = km.size();
+	int i;
+
+	// list the distinct k-mers of every sequence with the index of the
+	// sequence, and sort them, so that the postings of each k-mer follow
+	// each other in increasing order of sequence
+	vector< pair<unsigned int, int> > entries;
+	for( i = 0; i < n; i++ )
+	{
+		const vector<unsigned int>& c( km.codes(i) );
+		for( int p = 0; p < static_cast<int>( c.size() ); p++ )
+		{
+			if( p == 0 || c[p] != c[p-1] )
+			{
+				entries.push_back
+					( pair<unsigned int, int>( c[p], i ) );
+			}
+		}
+	}
+	sort( entries.begin(), entries.end() );
+
+	// then copy the postings of the k-mers that are not too frequent
+	keys_.clear();
+	offsets_.clear();
+	ids_.clear();
+	for( int b = 0, e = 0; b < static_cast<int>( entries.size() ); b = e )
+	{
+		for( e = b; e < static_cast<int>( entries.size() )
+			&& entries[e].first == entries[b].first; e++ ) { ; }
+
+		if( e - b > maxpostings_ )
+		{
+			continue;
+		}
+		keys_.push_back( entries[b].first );
+		offsets_.push_back( static_cast<int>( ids_.size() ) );
+		for( int p = b; p < e; p++ )
+		{
+			ids_.push_back( entries[p].second );
+		}
+	}
+	offsets_.push_back( static_cast<int>( ids_.size() ) );
+
+	// free the entries before building the candidate lists
+	vector< pair<unsigned int, int> >().swap( entries );
+
+	// count the k-mers each sequence shares with the others. Only the
+	// sequences actually found (touched) are reset afterwards
+	vector<int> count( n, 0 );
+	vector<int> touched;
+	vector< pair<int, int> > ranking;
+
+	candidates_.clear();
+	candidates_.resize( n );
+	for( i = 0; i < n; i++ )
+	{
+		const vector<unsigned int>& c( km.codes(i) );
+		touched.clear();
+		for( int p = 0; p < static_cast<int>( c.size() ); p++ )
+		{
+			int begin, end;
+			if( ( p > 0 && c[p] == c[p-1] ) || !find( c[p], begin, end ) )
+			{
+				continue;
+			}
+			for( int q = begin; q < end; q++ )
+			{
+				int j = ids_[q];
+				if( j != i && count[j]++ == 0 )
+				{
+					touched.push_back( j );
+				}
+			}
+		}
+
+		// rank the sequences sharing enough k-mers
+		ranking.clear();
+		for( int t = 0; t < static_cast<int>( touched.size() ); t++ )
+		{
+			int j = touched[t];
+			if( count[j] >= minshared_ )
+			{
+				ranking.push_back( pair<int, int>( count[j], j ) );
+			}
+			count[j] = 0;
+		}
+		sort( ranking.begin(), ranking.end(), ranked );
+		if( maxcandidates_ > 0
+			&& static_cast<int>( ranking.size() ) > maxcandidates_ )
+		{
+			ranking.resize( maxcandidates_ );
+		}
+
+		candidates_[i].reserve( ranking.size() );
+		for( int r = 0; r < static_cast<int>( ranking.size() ); r++ )
+		{
+			candidates_[i].push_back( ranking[r].second );
+		}
+	}
+}
+
+/******************************************************************************/
+
+// find the postings of a k-mer
+
+bool kmerindex::find( unsigned int code, int& begin, int& end ) const
+{
+	vector<unsigned int>::const_iterator pos
+		= lower_bound( keys_.begin(), keys_.end(), code );
+	if( pos == keys_.end() || *pos != code )
+	{
+		return false;
+	}
+	begin = offsets_[ pos - keys_.begin() ];
+	end = offsets_[ pos - keys_.begin() + 1 ];
+	return true;
+}
+
+/******************************************************************************/
+
+// all the candidate pairs, each once, with the smaller index first
+
+vector< pair<int, int> > kmerindex::pairs( void ) const
+{
+	vector< pair<int, int> > p;
+
+	for( int i = 0; i < static_cast<int>( candidates_.size() ); i++ )
+	{
+		for( int c = 0; c < static_cast<int>( candidates_[i].size() ); c++ )
+		{
+			int j = candidates_[i][c];
+			p.push_back( pair<int, int>( min( i, j ), max( i, j ) ) );
+		}
+	}
+	sort( p.begin(), p.end() );
+	p.erase( unique( p.begin(), p.end() ), p.end() );
+	return p;
+}
@@ -0,0 +1,110 @@
+	/*
+File:		kmerindex.h
+Title:		Class declaration for class "kmerindex", an inverted index of
+		the k-mers of a set of dna sequences.
+
+Description:
+
+1. OVERVIEW
+
+	The kmerindex class maps every k-mer (see kmer.h) to the sequences in
+which it is found. From it a ranked list of candidate partners is built for
+each sequence: the sequences sharing the most k-mers with it come first. Only
+the candidates of a sequence are likely to be significantly similar to it, so
+clustering programs can align them instead of all the n-1 other sequences.
+
+2. DATA MEMBERS
+
+	2.1. POSTINGS
+
+	The index is stored as three arrays: the distinct k-mers, sorted; for
+each of them the offset of its "postings" (the sorted indices of the sequences
+containing it); and the postings themselves, one after the other. A k-mer is
+looked up by binary search.
+
+	K-mers found in more than maxpostings sequences (e.g. poly-A tails and
+other low-complexity regions) are left out of the index. They say little
+about the similarity of two sequences, and their postings would make the
+candidate lists quadratic in size.
+
+	2.2. CANDIDATES
+
+	The candidates of a sequence are the sequences sharing at least
+minshared distinct k-mers with it, sorted by decreasing number of shared
+k-mers (and then by index). At most maxcandidates are kept for each
+sequence.
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR
+
+	The constructor takes the maximum number of postings of a k-mer, the
+minimum number of shared k-mers of a candidate, and the maximum number of
+candidates per sequence. A value of 0 or less for the last one keeps all the
+candidates.
+
+	3.2. OTHER FUNCTIONS
+
+		- build(): builds the index and the candidate lists from the
+	k-mer lists of a kmers object (which must have been built).
+		- candidates(): the ranked candidates of a sequence.
+		- pairs(): all the pairs (i, j), i < j, in which j is a candidate
+	of i or i a candidate of j.
+		- distinct(), postings(): the number of distinct k-mers in the
+	index, and the total number of postings.
+
+4. NOTES
+
+	Building the candidate lists costs the sum, over the k-mers of each
+sequence, of the length of their postings, so it is about linear in the
+number of sequences when the frequent k-mers are left out.
+
+	*/
+
+#ifndef KMERINDEX_H
+#define KMERINDEX_H
+
+#include <vector>
+#include <utility>
+#include "kmer.h"
+
+const int INDEXPOSTINGS = 1000;	// default maximum postings of a k-mer
+const int INDEXCANDIDATES = 100;	// default maximum candidates per sequence
+
+class kmerindex
+{
+	public:
+		// constructor
+		kmerindex( int mp = INDEXPOSTINGS, int ms = 1,
+			int mc = INDEXCANDIDATES );
+
+		// "get" functions
+		const vector<int>& candidates( int i ) const
+			{ return candidates_[i]; }
+		vector< pair<int, int> > pairs( void ) const;
+		int distinct( void ) const
+			{ return static_cast<int>( keys_.size() ); }
+		double postings( void ) const
+			{ return static_cast<double>( ids_.size() ); }
+
+		// other functions
+		void build( const kmers& );
+
+	private:
+		// the postings of a k-mer (end is past the last one). Returns
+		// false if the k-mer is not in the index
+		bool find( unsigned int, int&, int& ) const;
+
+		int maxpostings_;	// k-mers in more sequences are dropped
+		int minshared_;		// shared k-mers needed by a candidate
+		int maxcandidates_;	// candidates kept per sequence
+
+		vector<unsigned int> keys_;	// the sorted distinct k-mers
+		vector<int> offsets_;	// where the postings of each k-mer begin
+		vector<int> ids_;	// the postings
+
+		vector< vector<int> > candidates_;
+					// the ranked candidates of each sequence
+};
+
+#endif
@@ -0,0 +1,522 @@
+	/*
+File:		mpiest.cpp
+Title:		Distributed exhaustive EST clustering program (MPI)
+
+Description:	The distributed version of exest: the sequences of a FASTA
+		file are clustered by several processes (MPI ranks), on as
+		many nodes of a cluster, each of which reads and aligns its
+		own part of the pairs.
+
+		Type -h for command-line descriptions.
+
+		See end of this file for implementation details.
+
+		Modules needed: dna.h, dna.cpp, dynamic.h, dynamic.cpp,
+		striped.h, striped.cpp, allpairs.h, allpairs.cpp, device.h,
+		device.cu, kmer.h, kmer.cpp, fasta.h, fasta.cpp, seqstore.h,
+		seqstore.cpp, clusters.h, clusters.cpp. MPI and POSIX threads
+		must be installed.
+
+	*/
+
+/******************************************************************************/
+
+// imported files
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <cstdlib>
+#include <mpi.h>
+#include "dna.h"
+#include "dynamic.h"
+#include "seqstore.h"
+#include "fasta.h"
+#include "kmer.h"
+#include "allpairs.h"
+#include "clusters.h"
+
+/******************************************************************************/
+
+// function declarations
+
+void error( const string&, const string& );
+
+// send a shard to a rank while receiving another one from a rank
+void exchange( seqstore&, int, int, seqstore& );
+
+// the root of the cluster of a sequence, and the union of two clusters
+int find( vector<int>&, int );
+void unite( vector<int>&, int, int );
+
+/******************************************************************************/
+
+// global variables
+
+int myrank = 0, ranks = 1;	// the rank of this process, and their number
+
+/******************************************************************************/
+
+// main program
+
+int main( int argc, char** argv )
+{
+	MPI_Init( &argc, &argv );
+	MPI_Comm_rank( MPI_COMM_WORLD, &myrank );
+	MPI_Comm_size( MPI_COMM_WORLD, &ranks );
+
+	// the number of alignment threads of each rank (0: one per processor),
+	// the length of the k-mers of the prefilter (0: no prefilter), the
+	// X-drop value, and the input file
+	int threads = 0;
+	int k = 0;
+	float xdrop = DYNNOXDROP;
+	string file;
+
+	const string errormsg( "Incorrect option syntax. Use -h for help." );
+	const string usage( "\nDistributed exhaustive EST clustering. Read in "
+		"sequences from a FASTA file,\none part of it per MPI rank, "
+		"align all the pairs and print the clusters\nto stdout (see "
+		"exest). Usage: mpiest [options] file\n\n"
+		"Available options:\n"
+		"\t-threads int:\tspecify the number of alignment threads of\n"
+			"\t\t\teach rank. 0 (default) uses one per\n"
+			"\t\t\tprocessor.\n"
+		"\t-k int:\t\tonly align the pairs sharing enough k-mers\n"
+			"\t\t\tof length int (at most 16). 0 (default)\n"
+			"\t\t\taligns all the pairs.\n"
+		"\t-xdrop float:\tabandon the alignments that can no longer\n"
+			"\t\t\tbecome significant, allowing a slack of\n"
+			"\t\t\tfloat (0 is exact, larger values are faster).\n"
+		"\t-h(elp):\tprint this message.\n"
+		);
+
+	for( int i = 1; i < argc; i++ )
+	{
+		string opt( argv[i] );
+
+		// set the number of alignment threads
+		if( opt == "-threads" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				threads = atoi( argv[i] );
+				if( threads < 0 )
+				{
+					error( argv[0], errormsg );
+				}
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// set the length of the k-mers of the prefilter
+		if( opt == "-k" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				k = atoi( argv[i] );
+				if( k < 0 || k > KMERMAX )
+				{
+					error( argv[0], errormsg );
+				}
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// abandon the alignments that can no longer become significant
+		if( opt == "-xdrop" )
+		{
+			if( i+1 < argc )
+			{
+				i++;
+				xdrop = atof( argv[i] );
+				if( xdrop < 0 )
+				{
+					error( argv[0], errormsg );
+				}
+			}
+			else
+			{
+				error( argv[0], errormsg );
+			}
+			continue;
+		}
+
+		// print a help message
+		if( opt == "-h" || opt == "-help" )
+		{
+			if( myrank == 0 )
+			{
+				cout	<< argv[0] << ": " << endl
+					<< usage << endl;
+			}
+			MPI_Finalize();
+			return 0;
+		}
+
+		// the input file
+		if( opt[0] != '-' && file.empty() )
+		{
+			file = opt;
+			continue;
+		}
+
+		error( argv[0], errormsg );
+	}
+	if( file.empty() )
+	{
+		error( argv[0], errormsg );
+	}
+
+	// the alignment parameters. Each alignment thread reuses a copy of d1
+	// as its score-only workspace
+	dynamic d1( DYNMATCH, DYNMSMATCH, DYNGAPOPEN, DYNGAPXTND, DYNSIG,
+		DYNSCORE, xdrop );
+
+	// each rank reads its own shard of the input (see fasta.h)
+	seqstore mine, guest;
+	fasta input( file );
+	if( !input.good() )
+	{
+		error( argv[0], "ERROR: Input could not be read. Program "
+			"terminated." );
+	}
+	input.read( mine, myrank, ranks );
+
+	// the index of the first sequence of every shard
+	int m = static_cast<int>( mine.size() );
+	vector<int> base( ranks + 1, 0 );
+	MPI_Allgather( &m, 1, MPI_INT, &base[1], 1, MPI_INT, MPI_COMM_WORLD );
+	for( int r = 0; r < ranks; r++ )
+	{
+		base[r+1] += base[r];
+	}
+	int n = base[ranks];
+
+	if( myrank == 0 )
+	{
+		cout	<< "Number of sequences: " << n << "\n\n" << endl;
+	}
+
+	double start = MPI_Wtime();
+
+	// the pairs of the own shard, and then those between the own shard and
+	// the shards passed around the ring (see 1. of the notes)
+	vector< pair<int, int> > edges;
+	double alignments = 0;
+	for( int s = 0; 2 * s <= ranks; s++ )
+	{
+		if( s > 0 )
+		{
+			exchange( s == 1 ? mine : guest,
+				( myrank + ranks - 1 ) % ranks, ( myrank + 1 ) % ranks,
+				guest );
+		}
+
+		// with an even number of ranks, the shards half a ring apart
+		// meet twice, and are aligned the first time
+		int other = ( myrank + s ) % ranks;
+		if( 2 * s == ranks && myrank >= ranks / 2 )
+		{
+			continue;
+		}
+
+		// the own sequences first, then those of the other shard
+		vector<dna> sequences, visiting;
+		mine.views( sequences );
+		int rows = static_cast<int>( sequences.size() );
+		if( s > 0 )
+		{
+			guest.views( visiting );
+			sequences.insert( sequences.end(), visiting.begin(),
+				visiting.end() );
+		}
+
+		allpairs engine( sequences, d1, threads );
+		kmers filter( k > 0 ? k : KMERDEFAULT );
+		if( k > 0 )
+		{
+			filter.build( sequences );
+			engine.filter( &filter );
+		}
+		if( s == 0 )
+		{
+			engine.run();
+		}
+		else
+		{
+			engine.run( rows, rows );
+		}
+		alignments += engine.alignments();
+
+		// the edges, with the global indices of their sequences
+		const vector< pair<int, int> >& found( engine.edges() );
+		for( int e = 0; e < static_cast<int>( found.size() ); e++ )
+		{
+			int i = base[myrank] + found[e].first;
+			int j = ( s == 0 ) ? base[myrank] + found[e].second
+				: base[other] + found[e].second - rows;
+			edges.push_back( pair<int, int>( min( i, j ),
+				max( i, j ) ) );
+		}
+	}
+
+	// the clusters of the own edges, merged up a binary tree of the ranks
+	// (see 2. of the notes)
+	vector<int> parent( n );
+	int v;
+	for( v = 0; v < n; v++ )
+	{
+		parent[v] = v;
+	}
+	for( int e = 0; e < static_cast<int>( edges.size() ); e++ )
+	{
+		unite( parent, edges[e].first, edges[e].second );
+	}
+
+	vector<int> forest;
+	for( int d = 1; d < ranks; d *= 2 )
+	{
+		if( myrank % ( 2 * d ) == d )
+		{
+			// the sequences that are not roots, and their roots
+			forest.clear();
+			for( v = 0; v < n; v++ )
+			{
+				int root = find( parent, v );
+				if( root != v )
+				{
+					forest.push_back( v );
+					forest.push_back( root );
+				}
+			}
+			int size = static_cast<int>( forest.size() );
+			MPI_Send( &size, 1, MPI_INT, myrank - d, 0,
+				MPI_COMM_WORLD );
+			MPI_Send( forest.empty() ? 0 : &forest[0], size, MPI_INT,
+				myrank - d, 1, MPI_COMM_WORLD );
+			break;
+		}
+		if( myrank % ( 2 * d ) == 0 && myrank + d < ranks )
+		{
+			int size = 0;
+			MPI_Recv( &size, 1, MPI_INT, myrank + d, 0,
+				MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+			forest.resize( size + 1 );
+			MPI_Recv( &forest[0], size, MPI_INT, myrank + d, 1,
+				MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+			for( int f = 0; f < size; f += 2 )
+			{
+				unite( parent, forest[f], forest[f+1] );
+			}
+		}
+	}
+
+	double total = 0;
+	MPI_Reduce( &alignments, &total, 1, MPI_DOUBLE, MPI_SUM, 0,
+		MPI_COMM_WORLD );
+	int totalsecs = static_cast<int>( MPI_Wtime() - start );
+
+	if( myrank == 0 )
+	{
+		// every cluster as a star around its first member, so that the
+		// traversal lists its members in increasing order
+		vector<int> first( n, -1 );
+		vector< pair<int, int> > stars;
+		for( v = 0; v < n; v++ )
+		{
+			int root = find( parent, v );
+			if( first[root] < 0 )
+			{
+				first[root] = v;
+			}
+			else
+			{
+				stars.push_back( pair<int, int>( first[root], v ) );
+			}
+		}
+		sort( stars.begin(), stars.end() );
+
+		clusters graph;
+		graph.build( n, stars );
+
+		float tempscore( 0 ), totscore( 0 );
+
+		for( int i = 0, j = 0; i < n; i++ )
+		{
+			if( !graph.visited(i) && graph.degree(i) != 0 )
+			{
+				cout	<< "Cluster " << j << endl << " ";
+				tempscore = graph.traverse( i );
+				for( int c = 0; c < tempscore; c++ )
+				{
+					cout	<< graph.members()[c] << " ";
+				}
+				cout	<< endl;
+				totscore += ( tempscore-1 ) * ( tempscore-1 );
+				j++;
+			}
+		}
+
+		cout	<< "Singletons: " << endl;
+		for( int i = 0; i < n; i++ )
+		{
+			if( !graph.visited(i) )
+			{
+				cout	<< i << " ";
+			}
+		}
+		cout	<< "\n\n SCORE: " << totscore << endl
+			<< " TIME: " << totalsecs << endl
+			<< " ALIGNMENTS: " << static_cast<long>( total )
+			<< endl;
+	}
+
+	MPI_Finalize();
+	return 0;
+}
+
+/******************************************************************************/
+
+// send a shard of sequences to a rank while receiving another one from a rank,
+//	as the lengths of the sequences followed by their nucleotide codes. The
+//	shards may be the same store.
+
+void exchange( seqstore& out, int to, int from, seqstore& in )
+{
+	vector<dna> sequences;
+	out.views( sequences );
+
+	int count = static_cast<int>( sequences.size() );
+	vector<int> lengths( count + 1 );
+	int total = 0;
+	int s;
+	for( s = 0; s < count; s++ )
+	{
+		lengths[s] = sequences[s].length();
+		total += lengths[s];
+	}
+	vector<unsigned char> codes( total + 1 );
+	for( s = 0, total = 0; s < count; s++ )
+	{
+		sequences[s].unpack( &codes[total] );
+		total += lengths[s];
+	}
+
+	int sizes[2] = { count, total }, received[2];
+	MPI_Sendrecv( sizes, 2, MPI_INT, to, 0, received, 2, MPI_INT, from, 0,
+		MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+
+	vector<int> rlengths( received[0] + 1 );
+	vector<unsigned char> rcodes( received[1] + 1 );
+	MPI_Sendrecv( &lengths[0], count, MPI_INT, to, 1, &rlengths[0],
+		received[0], MPI_INT, from, 1, MPI_COMM_WORLD,
+		MPI_STATUS_IGNORE );
+	MPI_Sendrecv( &codes[0], total, MPI_UNSIGNED_CHAR, to, 2, &rcodes[0],
+		received[1], MPI_UNSIGNED_CHAR, from, 2, MPI_COMM_WORLD,
+		MPI_STATUS_IGNORE );
+
+	// the names are not needed to align the sequences
+	in.clear();
+	in.reserve( received[0], received[1] );
+	total = 0;
+	for( s = 0; s < received[0]; s++ )
+	{
+		in.add( "", &rcodes[total], rlengths[s] );
+		total += rlengths[s];
+	}
+}
+
+/******************************************************************************/
+
+// the root of the cluster of sequence v, halving the path to it
+
+int find( vector<int>& parent, int v )
+{
+	while( parent[v] != v )
+	{
+		parent[v] = parent[ parent[v] ];
+		v = parent[v];
+	}
+	return v;
+}
+
+/******************************************************************************/
+
+// join the clusters of sequences v and w, under the smaller root
+
+void unite( vector<int>& parent, int v, int w )
+{
+	v = find( parent, v );
+	w = find( parent, w );
+	if( v < w )
+	{
+		parent[w] = v;
+	}
+	else if( w < v )
+	{
+		parent[v] = w;
+	}
+}
+
+/******************************************************************************/
+
+// print an error message from the first rank, and stop all the ranks
+
+void error( const string& progname, const string& errormsg )
+{
+	if( myrank == 0 )
+	{
+		cerr	<< progname << ": " << errormsg << endl;
+	}
+	MPI_Abort( MPI_COMM_WORLD, EXIT_FAILURE );
+	exit( EXIT_FAILURE );
+}
+
+/******************************************************************************/
+
+/*
+IMPLEMENTATION NOTES
+
+1. The pairs
+
+		The input is cut into as many shards as there are ranks, by ranges
+	of bytes (see fasta.h), so that every rank only reads and parses its
+	own part of the file. The sequences of a shard are numbered after those
+	of the shards before it.
+
+		Each rank aligns the pairs of its own shard, and then the pairs
+	between its shard and those of the others, which are passed around a
+	ring: at step s, every rank sends the shard it holds to the previous
+	rank and receives the one of the next rank, so that rank r then holds
+	shard r+s (mod the number of ranks). The pairs between two shards are
+	aligned once, by the first of the two ranks to hold the other's shard,
+	so the triangle of pairs is divided evenly, and every rank only ever
+	holds two shards.
+
+2. The clusters
+
+		Each rank joins the sequences of its significant pairs in a
+	union-find forest. The forests are then merged up a binary tree of the
+	ranks: at the level d (1, 2, 4...), rank r + d sends every sequence that
+	is not a root with its root to rank r, which joins them in its own
+	forest. A forest sent has at most one pair per sequence, however many
+	significant pairs it was built from, and rank 0 ends with the clusters
+	of all the pairs.
+
+		The clusters are the same as those of exest, and are printed in
+	the same order and format, but the members of a cluster are listed in
+	increasing order rather than in the order of a traversal of the pairs.
+*/
@@ -0,0 +1,125 @@
+	/*
+File:		profile.cpp
+Title:		Class definitions for class "profile" (declared in profile.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <time.h>
+#include "profile.h"
+
+// the names of the columns of the file, after the label, the time and the best
+// score, in the order of profilecount and of profilephase
+const char* PROFCOUNTNAMES[PROFCOUNTS] = { "lookups", "hits", "filtered",
+	"archived", "aligned", "stopped", "abandoned", "cells" };
+const char* PROFPHASENAMES[PROFPHASES] = { "input", "align", "cache",
+	"objective", "operators", "output" };
+
+/******************************************************************************/
+
+// constructor for class profile
+
+profile::profile( void )
+	:
+	active_( false ),
+	start_( 0 )
+{
+	clear();
+}
+
+/******************************************************************************/
+
+// the time on the monotonic clock, in seconds
+
+double profile::now( void )
+{
+	timespec t;
+	clock_gettime( CLOCK_MONOTONIC, &t );
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/******************************************************************************/
+
+// create the file and write its header
+
+bool profile::open( const string& file )
+{
+	file_.open( file.c_str(), ios::out | ios::trunc );
+	if( !file_.good() )
+	{
+		return false;
+	}
+
+	file_	<< "row,time,best";
+	int k;
+	for( k = 0; k < PROFCOUNTS; k++ )
+	{
+		file_	<< "," << PROFCOUNTNAMES[k];
+	}
+	for( k = 0; k < PROFPHASES; k++ )
+	{
+		file_	<< "," << PROFPHASENAMES[k];
+	}
+	file_	<< endl;
+
+	clear();
+	start_ = now();
+	active_ = true;
+	return true;
+}
+
+/******************************************************************************/
+
+// write the values accumulated since the last row, and clear them
+
+void profile::row( const string& label, double best )
+{
+	if( !active_ )
+	{
+		return;
+	}
+
+	file_	<< label << "," << now() - start_ << "," << best;
+	int k;
+	for( k = 0; k < PROFCOUNTS; k++ )
+	{
+		file_	<< "," << counts_[k];
+	}
+	for( k = 0; k < PROFPHASES; k++ )
+	{
+		file_	<< "," << seconds_[k];
+	}
+	file_	<< endl;
+	clear();
+}
+
+/******************************************************************************/
+
+// write the row of a generation
+
+void profile::row( int generation, double best )
+{
+	ostringstream label;
+	label << generation;
+	row( label.str(), best );
+}
+
+/******************************************************************************/
+
+// clear the times and the counts
+
+void profile::clear( void )
+{
+	int k;
+	for( k = 0; k < PROFPHASES; k++ )
+	{
+		seconds_[k] = 0;
+	}
+	for( k = 0; k < PROFCOUNTS; k++ )
+	{
+		counts_[k] = 0;
+	}
+}
@@ -0,0 +1,116 @@
+	/*
+File:		profile.h
+Title:		Class declaration for class "profile", the timers and counters
+		of the phases of a run of gaest.
+
+Description:
+
+1. OVERVIEW
+
+	The trace file of gaest only gives the time of every generation, in
+seconds, so it does not tell whether a slow run spends its time aligning pairs
+or running the GA. The profile class accumulates the time spent in each phase
+of a run (see profilephase) on a high-resolution clock, and counts the events
+of the cache and of the alignments (see profilecount). Every call to row()
+writes the values accumulated since the previous row as a line of a CSV file,
+so that gaest writes one row for the input, one per generation and one for the
+output.
+
+2. DATA MEMBERS
+
+	2.1. PHASES
+
+	The phases are the input (reading and packing the sequences), the
+alignments, the lookups of the cache, the objective (the evaluation of the
+individuals), the genetic operators (selection, crossover and mutation,
+excluding the alignments and the lookups they need), and the output. The time
+of a phase is wall-clock time: a phase performed by several threads at once
+counts once.
+
+	2.2. COUNTS
+
+	The events counted are the lookups of the cache and its hits, the pairs
+rejected by the k-mer prefilter or found in the cache file without being
+aligned, the pairs aligned, those of them stopped early because they reached
+significance, those abandoned early in X-drop mode, and the cells their
+alignments actually computed (see dynamic.h, cells()), which the alignments
+stopped or abandoned early leave out.
+
+	2.3. FILE
+
+	The file has a header line, and then one line per row: its label, the
+time since the file was opened, the best score, the counts and the times of
+the phases (in seconds), separated by commas.
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR
+
+	The constructor creates an inactive profile: open() starts it.
+
+	3.2. OTHER FUNCTIONS
+
+		- open(): creates the file, writes its header and starts the
+	clock. Returns false if the file can not be created.
+		- active(): has the file been opened? The timers are meant to be
+	read only then, so that the runs without a profile do not pay for the
+	clock.
+		- now(): the time on a clock that never goes back, in seconds.
+		- add(): adds time to a phase.
+		- count(): adds to a count.
+		- seconds(): the time of a phase since the last row.
+		- row(): writes the values since the last row, and clears them.
+	The label of the row is a string, or the number of a generation.
+
+4. NOTES
+
+	The clock is read with clock_gettime() (CLOCK_MONOTONIC), whose
+resolution is about a nanosecond and which costs some tens of nanoseconds per
+call: timing every lookup of the cache slows it down noticeably, so only the
+runs asked for a profile are timed.
+
+	*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <fstream>
+#include <string>
+
+// the phases timed, and the events counted (see 2.1 and 2.2)
+enum profilephase { PROFINPUT, PROFALIGN, PROFCACHE, PROFOBJECTIVE,
+	PROFOPERATORS, PROFOUTPUT, PROFPHASES };
+enum profilecount { PROFLOOKUPS, PROFHITS, PROFFILTERED, PROFARCHIVED,
+	PROFALIGNED, PROFSTOPPED, PROFABANDONED, PROFCELLS, PROFCOUNTS };
+
+class profile
+{
+	public:
+		// constructor
+		profile( void );
+
+		// "get" functions
+		bool active( void ) const { return active_; }
+		double seconds( profilephase p ) const { return seconds_[p]; }
+		static double now( void );
+
+		// other functions
+		bool open( const string& );
+		void add( profilephase p, double s ) { seconds_[p] += s; }
+		void count( profilecount c, double n = 1 ) { counts_[c] += n; }
+		void row( const string&, double );
+		void row( int, double );
+
+	private:
+		// clear the values accumulated
+		void clear( void );
+
+		bool active_;		// is the file open?
+		ofstream file_;		// the file
+		double start_;		// the time it was opened
+
+		double seconds_[PROFPHASES];	// the times since the last row
+		double counts_[PROFCOUNTS];	// and the counts
+};
+
+#endif
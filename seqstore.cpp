@@ -0,0 +1,128 @@
+	/*
+File:		seqstore.cpp
+Title:		Class definitions for class "seqstore" (declared in seqstore.h)
+Description:	See class declaration for description of friend and member
+		functions. See below for details on implementation.
+	*/
+
+#include <vector>
+#include <string>
+#include <utility>
+#include "dna.h"
+#include "seqstore.h"
+
+/******************************************************************************/
+
+// constructor for class seqstore. The lists of ambiguous nucleotides and the
+//	names are delimited by their starts, so there is always one more of
+//	those than sequences
+
+seqstore::seqstore( void )
+{
+	ambigstart_.push_back( 0 );
+	namestart_.push_back( 0 );
+}
+
+/******************************************************************************/
+
+// append a sequence given its name and its n nucleotide codes (none of them X)
+
+void seqstore::add( const string& name, const unsigned char* codes, int n )
+{
+	offsets_.push_back( bases_.size() );
+	lengths_.push_back( n );
+	packs_.push_back( dna::packing() );
+
+	// the new ambiguous nucleotides are appended to the pool, positioned
+	// from the start of the sequence
+	dna::pack( codes, n, dna::packing(), bases_, ambig_ );
+	ambigstart_.push_back( static_cast<int>( ambig_.size() ) );
+
+	names_.insert( names_.end(), name.begin(), name.end() );
+	namestart_.push_back( names_.size() );
+}
+
+/******************************************************************************/
+
+// append a dna object (or a view)
+
+void seqstore::add( const dna& s )
+{
+	codes_.resize( s.length() + 1 );
+	s.unpack( &codes_[0] );
+	add( s.name(), &codes_[0], s.length() );
+}
+
+/******************************************************************************/
+
+// allocate room for n sequences of l nucleotides in all
+
+void seqstore::reserve( int n, double l )
+{
+	offsets_.reserve( offsets_.size() + n );
+	lengths_.reserve( lengths_.size() + n );
+	packs_.reserve( packs_.size() + n );
+	ambigstart_.reserve( ambigstart_.size() + n );
+	namestart_.reserve( namestart_.size() + n );
+
+	// each sequence may take one partly used byte more
+	double b = ( dna::packing() == PACK4 ? l / 2 : l / 4 ) + n;
+	bases_.reserve( bases_.size() + static_cast<size_t>( b ) );
+}
+
+/******************************************************************************/
+
+// empty the store (and free its memory)
+
+void seqstore::clear( void )
+{
+	vector<unsigned char>().swap( bases_ );
+	vector<size_t>().swap( offsets_ );
+	vector<int>().swap( lengths_ );
+	vector<packmode>().swap( packs_ );
+	vector< pair<int, nucleotide> >().swap( ambig_ );
+	vector<int>( 1, 0 ).swap( ambigstart_ );
+	vector<char>().swap( names_ );
+	vector<size_t>( 1, 0 ).swap( namestart_ );
+}
+
+/******************************************************************************/
+
+// the memory used by the arrays of the store
+
+double seqstore::bytes( void ) const
+{
+	return static_cast<double>( bases_.capacity() )
+		+ ambig_.capacity() * sizeof( pair<int, nucleotide> )
+		+ names_.capacity()
+		+ offsets_.capacity() * sizeof( size_t )
+		+ namestart_.capacity() * sizeof( size_t )
+		+ ( lengths_.capacity() + ambigstart_.capacity() ) * sizeof( int )
+		+ packs_.capacity() * sizeof( packmode );
+}
+
+/******************************************************************************/
+
+// replace the contents of a vector by views of all the sequences of the store
+
+void seqstore::views( vector<dna>& out ) const
+{
+	int n = size();
+
+	out.clear();
+	out.resize( n );
+	for( int i = 0; i < n; i++ )
+	{
+		dna& d = out[i];
+		int a = ambigstart_[i];
+
+		d.pack_ = packs_[i];
+		d.length_ = lengths_[i];
+		d.packed_ = bases_.empty() ? 0 : &bases_[0] + offsets_[i];
+		d.ambigs_ = ambigstart_[i+1] - a;
+		d.ambiglist_ = d.ambigs_ > 0 ? &ambig_[a] : 0;
+		d.view_ = true;
+		d.nameptr_ = names_.empty() ? "" : &names_[0] + namestart_[i];
+		d.namelen_ = static_cast<int>( namestart_[i+1] - namestart_[i] );
+	}
+}
@@ -0,0 +1,110 @@
+	/*
+File:		seqstore.h
+Title:		Class declaration for class "seqstore", a contiguous store of
+		dna sequences.
+
+Description:
+
+1. OVERVIEW
+
+	A vector of dna objects (see dna.h) makes two or three small heap
+allocations per sequence: the name, the packed sequence and, in PACK2, the
+list of ambiguous nucleotides. For a library of hundreds of thousands of ESTs
+these are scattered all over the heap, and the all-pairs loops (see
+allpairs.h) touch a different part of it at every pair. The seqstore class
+keeps all the sequences of a set in a few large arrays instead, one after the
+other, and hands out dna "views" of them (see section 3.2 of dna.h), which
+point into the arrays and can be used wherever a dna object is expected, in
+particular by the dynamic class (see dynamic.h).
+
+2. DATA MEMBERS
+
+	2.1. SEQUENCES
+
+	The packed sequences are kept in a single buffer, each starting on a new
+byte, in the packing that was current when it was added. The offset in the
+buffer, the length and the packing of each sequence are kept in three arrays.
+
+	2.2. AMBIGUOUS NUCLEOTIDES
+
+	The lists of ambiguous nucleotides of the PACK2 sequences are kept one
+after the other in a single pool, with the offset of the list of each
+sequence (the list of sequence i ends where that of sequence i+1 begins). The
+positions in each list are relative to the start of its sequence.
+
+	2.3. NAMES
+
+	The names are kept one after the other in a pool of characters (not
+null-terminated), with the offset of each.
+
+3. FUNCTIONS
+
+	3.1. CONSTRUCTOR
+
+	The constructor creates an empty store.
+
+	3.2. OTHER FUNCTIONS
+
+		- add(): appends a sequence, given its name and nucleotide codes, or
+	as a dna object.
+		- reserve(): allocates room for a number of sequences totalling a
+	number of nucleotides.
+		- views(): replaces the contents of a vector of dna objects by views
+	of all the sequences of the store.
+		- clear(): empties the store.
+		- size(): the number of sequences.
+		- bytes(): the memory used by the store.
+
+4. NOTES
+
+	The views are invalidated by add() and clear(), which can move the
+arrays: views() must be called again after the store is modified. Copies of
+the views (e.g. the sequences given to a dynamic object) are views too, and so
+are just as cheap to make.
+
+	*/
+
+#ifndef SEQSTORE_H
+#define SEQSTORE_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstddef>
+#include "dna.h"
+
+class seqstore
+{
+	public:
+		// constructor
+		seqstore( void );
+
+		// "get" functions
+		int size( void ) const
+			{ return static_cast<int>( lengths_.size() ); }
+		double bytes( void ) const;
+		void views( vector<dna>& ) const;
+
+		// other functions
+		void add( const string&, const unsigned char*, int );
+		void add( const dna& );
+		void reserve( int, double );
+		void clear( void );
+
+	private:
+		vector<unsigned char> bases_;	// the packed sequences
+		vector<size_t> offsets_;	// where each sequence starts,
+		vector<int> lengths_;		// its length
+		vector<packmode> packs_;	// and its packing
+
+		vector< pair<int, nucleotide> > ambig_;
+					// the ambiguous nucleotides (PACK2)
+		vector<int> ambigstart_;	// where the list of each starts
+
+		vector<char> names_;		// the names
+		vector<size_t> namestart_;	// where each name starts
+
+		vector<unsigned char> codes_;	// to unpack a dna object
+};
+
+#endif
@@ -0,0 +1,503 @@
+	/*
+File:		striped.cpp
+Title:		Definition of class "striped", a vectorized local alignment
+		kernel (declared in striped.h)
+Description:	Contains the integer scoring, the query profiles, the runtime
+		selection of the instruction set, and the SSE2 and NEON
+		versions of the kernel. The AVX2 version is compiled separately
+		(striped_avx2.cpp), since it needs different compiler flags.
+		The kernel itself is in stripedk.h.
+	*/
+
+#include <vector>
+#include <cstring>
+#include "dna.h"
+#include "striped.h"
+#include "stripedk.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <emmintrin.h>
+#define STRIPED_X86
+#elif defined( __aarch64__ )
+#include <arm_neon.h>
+#define STRIPED_NEON
+#endif
+
+// the AVX2 kernels (striped_avx2.cpp). They are only selected if the CPU
+//	supports AVX2, and are null if the file was compiled without it.
+extern stripedfn stripedavx2word;
+extern stripedfn stripedavx2byte;
+extern batchfn stripedavx2bword;
+extern batchfn stripedavx2bbyte;
+
+/******************************************************************************/
+
+// SSE2 traits for the kernel (see stripedk.h)
+
+#ifdef STRIPED_X86
+
+struct sse2word
+{
+	typedef __m128i V;
+	typedef short E;
+	static const int lanes = 8;
+
+	static V zero( void ) { return _mm_setzero_si128(); }
+	static V set( int a ) { return _mm_set1_epi16( a ); }
+	static V load( const V* p ) { return _mm_load_si128( p ); }
+	static void store( V* p, V a ) { _mm_store_si128( p, a ); }
+	static V addp( V h, V p, V ) { return _mm_adds_epi16( h, p ); }
+	static V subs( V a, V b ) { return _mm_subs_epu16( a, b ); }
+	static V max( V a, V b ) { return _mm_max_epi16( a, b ); }
+	static V shift( V a ) { return _mm_slli_si128( a, 2 ); }
+	static bool anygt( V a, V b )
+		{ return _mm_movemask_epi8( _mm_cmpgt_epi16( a, b ) ) != 0; }
+	static int hmax( V a )
+	{
+		a = _mm_max_epi16( a, _mm_srli_si128( a, 8 ) );
+		a = _mm_max_epi16( a, _mm_srli_si128( a, 4 ) );
+		a = _mm_max_epi16( a, _mm_srli_si128( a, 2 ) );
+		return static_cast<short>( _mm_extract_epi16( a, 0 ) );
+	}
+};
+
+struct sse2byte
+{
+	typedef __m128i V;
+	typedef unsigned char E;
+	static const int lanes = 16;
+
+	static V zero( void ) { return _mm_setzero_si128(); }
+	static V set( int a ) { return _mm_set1_epi8( static_cast<char>( a ) ); }
+	static V load( const V* p ) { return _mm_load_si128( p ); }
+	static void store( V* p, V a ) { _mm_store_si128( p, a ); }
+	static V addp( V h, V p, V bias )
+		{ return _mm_subs_epu8( _mm_adds_epu8( h, p ), bias ); }
+	static V subs( V a, V b ) { return _mm_subs_epu8( a, b ); }
+	static V max( V a, V b ) { return _mm_max_epu8( a, b ); }
+	static V shift( V a ) { return _mm_slli_si128( a, 1 ); }
+	static bool anygt( V a, V b )
+	{
+		// a > b for unsigned bytes iff a - b (saturated) is not 0
+		V d = _mm_cmpeq_epi8( _mm_subs_epu8( a, b ), _mm_setzero_si128() );
+		return _mm_movemask_epi8( d ) != 0xffff;
+	}
+	static int hmax( V a )
+	{
+		a = _mm_max_epu8( a, _mm_srli_si128( a, 8 ) );
+		a = _mm_max_epu8( a, _mm_srli_si128( a, 4 ) );
+		a = _mm_max_epu8( a, _mm_srli_si128( a, 2 ) );
+		a = _mm_max_epu8( a, _mm_srli_si128( a, 1 ) );
+		return _mm_extract_epi16( a, 0 ) & 0xff;
+	}
+};
+
+#endif
+
+/******************************************************************************/
+
+// NEON traits for the kernel (see stripedk.h)
+
+#ifdef STRIPED_NEON
+
+struct neonword
+{
+	typedef int16x8_t V;
+	typedef short E;
+	static const int lanes = 8;
+
+	static V zero( void ) { return vdupq_n_s16( 0 ); }
+	static V set( int a ) { return vdupq_n_s16( a ); }
+	static V load( const V* p )
+		{ return vld1q_s16( reinterpret_cast<const short*>( p ) ); }
+	static void store( V* p, V a )
+		{ vst1q_s16( reinterpret_cast<short*>( p ), a ); }
+	static V addp( V h, V p, V ) { return vqaddq_s16( h, p ); }
+	static V subs( V a, V b )
+	{
+		return vreinterpretq_s16_u16( vqsubq_u16(
+			vreinterpretq_u16_s16( a ), vreinterpretq_u16_s16( b ) ) );
+	}
+	static V max( V a, V b ) { return vmaxq_s16( a, b ); }
+	static V shift( V a ) { return vextq_s16( vdupq_n_s16( 0 ), a, 7 ); }
+	static bool anygt( V a, V b ) { return vmaxvq_u16( vcgtq_s16( a, b ) ); }
+	static int hmax( V a ) { return vmaxvq_s16( a ); }
+};
+
+struct neonbyte
+{
+	typedef uint8x16_t V;
+	typedef unsigned char E;
+	static const int lanes = 16;
+
+	static V zero( void ) { return vdupq_n_u8( 0 ); }
+	static V set( int a ) { return vdupq_n_u8( a ); }
+	static V load( const V* p )
+		{ return vld1q_u8( reinterpret_cast<const unsigned char*>( p ) ); }
+	static void store( V* p, V a )
+		{ vst1q_u8( reinterpret_cast<unsigned char*>( p ), a ); }
+	static V addp( V h, V p, V bias )
+		{ return vqsubq_u8( vqaddq_u8( h, p ), bias ); }
+	static V subs( V a, V b ) { return vqsubq_u8( a, b ); }
+	static V max( V a, V b ) { return vmaxq_u8( a, b ); }
+	static V shift( V a ) { return vextq_u8( vdupq_n_u8( 0 ), a, 15 ); }
+	static bool anygt( V a, V b ) { return vmaxvq_u8( vcgtq_u8( a, b ) ); }
+	static int hmax( V a ) { return vmaxvq_u8( a ); }
+};
+
+#endif
+
+/******************************************************************************/
+
+// definition of static elements of class striped
+
+	// the selected instruction set and its kernels (set by select())
+	stripedfn striped::word_( 0 );
+	stripedfn striped::byte_( 0 );
+	batchfn striped::bword_( 0 );
+	batchfn striped::bbyte_( 0 );
+	int striped::bytes_( 0 );
+	simdset striped::isa_( striped::select() );
+
+/******************************************************************************/
+
+// select the best instruction set available on the current CPU
+
+simdset striped::select( void )
+{
+#ifdef STRIPED_X86
+	if( stripedavx2word != 0 && __builtin_cpu_supports( "avx2" ) )
+	{
+		word_ = stripedavx2word;
+		byte_ = stripedavx2byte;
+		bword_ = stripedavx2bword;
+		bbyte_ = stripedavx2bbyte;
+		bytes_ = 32;
+		return SIMDAVX2;
+	}
+	word_ = stripedkernel<sse2word>;
+	byte_ = stripedkernel<sse2byte>;
+	bword_ = stripedbatch<sse2word>;
+	bbyte_ = stripedbatch<sse2byte>;
+	bytes_ = 16;
+	return SIMDSSE2;
+#elif defined( STRIPED_NEON )
+	word_ = stripedkernel<neonword>;
+	byte_ = stripedkernel<neonbyte>;
+	bword_ = stripedbatch<neonword>;
+	bbyte_ = stripedbatch<neonbyte>;
+	bytes_ = 16;
+	return SIMDNEON;
+#else
+	return SIMDNONE;
+#endif
+}
+
+/******************************************************************************/
+
+// the name of the selected instruction set
+
+const char* striped::isa( void )
+{
+	switch( isa_ )
+	{
+		case SIMDSSE2:
+			return "SSE2";
+		case SIMDAVX2:
+			return "AVX2";
+		case SIMDNEON:
+			return "NEON";
+		default:
+			return "none";
+	}
+}
+
+/******************************************************************************/
+
+// default constructor for class striped
+
+striped::striped( void )
+	:
+	query_( 0 ), qlen_( 0 ), stale_( true ), exact_( false ),
+	igo_( 0 ), igx_( 0 ), maxs_( 0 ), bias_( 0 ),
+	seg16_( 0 ), seg8_( 0 ),
+	score_( 0 ), xend_( 0 ), yend_( 0 ), columns_( 0 )
+{
+}
+
+/******************************************************************************/
+
+// set the integer scores: a table of DNACODES x DNACODES scores (indexed by the
+//	codes of the query and target nucleotides), and the gap penalties (as
+//	negative numbers, like those of dynamic). Returns false if the scores
+//	do not fit in 16 bits, in which case the kernel can not be used.
+
+bool striped::scoring( const int* table, int go, int gx )
+{
+	int mins = 0;
+
+	// the profile must be rebuilt if the scoring changes
+	if( !exact_ || go != -igo_ || gx != -igx_ ||
+		memcmp( table, table_, sizeof( table_ ) ) != 0 )
+	{
+		stale_ = true;
+	}
+
+	memcpy( table_, table, sizeof( table_ ) );
+	maxs_ = 0;
+	for( int a = 0; a < DNACODES; a++ )
+	{
+		for( int b = 0; b < DNACODES; b++ )
+		{
+			if( table_[a][b] > maxs_ ) maxs_ = table_[a][b];
+			if( table_[a][b] < mins ) mins = table_[a][b];
+		}
+	}
+	igo_ = -go;
+	igx_ = -gx;
+	bias_ = -mins;
+
+	// the gaps must be penalties, and the scores must fit in 16 bits
+	exact_ = !( igo_ < 0 || igx_ < 0 || igo_ > 16384 || igx_ > 16384 ||
+		maxs_ > 16384 || bias_ > 16384 );
+
+	return exact_;
+}
+
+/******************************************************************************/
+
+// set the query sequence. The profile is only rebuilt if the query or the
+//	scoring have changed since it was last built.
+
+void striped::query( const dna& q )
+{
+	if( &q == query_ && q.length() == qlen_ && !stale_ )
+	{
+		return;
+	}
+	query_ = &q;
+	qlen_ = q.length();
+	profile();
+	stale_ = false;
+}
+
+/******************************************************************************/
+
+// build the 16-bit and 8-bit striped profiles of the query, and size the
+//	workspace. Element t of segment k corresponds to query position
+//	t * segLen + k. Positions past the end of the query get the lowest
+//	possible score, so that they never extend an alignment.
+
+void striped::profile( void )
+{
+	const dna& q( *query_ );
+	int lanes16 = bytes_ / 2, lanes8 = bytes_;
+
+	seg16_ = ( qlen_ + lanes16 - 1 ) / lanes16;
+	seg8_ = ( qlen_ + lanes8 - 1 ) / lanes8;
+	if( seg16_ < 1 ) seg16_ = 1;
+	if( seg8_ < 1 ) seg8_ = 1;
+
+	short* p16 = reinterpret_cast<short*>
+		( aligned( prof16_, DNACODES * seg16_ * bytes_ ) );
+	unsigned char* p8 = reinterpret_cast<unsigned char*>
+		( aligned( prof8_, DNACODES * seg8_ * bytes_ ) );
+
+	// the unpacked codes of the query, also used by the batch kernel
+	codes_.resize( qlen_ > 0 ? qlen_ : 1 );
+	q.unpack( &codes_[0] );
+	const vector<unsigned char>& codes( codes_ );
+
+	for( int b = 0; b < DNACODES; b++ )
+	{
+		for( int k = 0; k < seg16_; k++ )
+		{
+			for( int t = 0; t < lanes16; t++ )
+			{
+				int i = t * seg16_ + k;
+				*p16++ = ( i < qlen_ ) ?
+					table_[ codes[i] ][b] : -16384;
+			}
+		}
+		for( int k = 0; k < seg8_; k++ )
+		{
+			for( int t = 0; t < lanes8; t++ )
+			{
+				int i = t * seg8_ + k;
+				int s = ( i < qlen_ ) ? table_[ codes[i] ][b] + bias_ : 0;
+				*p8++ = static_cast<unsigned char>
+					( s > 255 ? 255 : s );
+			}
+		}
+	}
+
+	// four columns of segments (see stripedk.h); the 8-bit segments are
+	// never longer than the 16-bit ones
+	aligned( work_, 4 * seg16_ * bytes_ );
+}
+
+/******************************************************************************/
+
+// align a target sequence against the query. The 8-bit kernel is used if only
+//	the stop threshold matters, and it fits in 8 bits. Returns false if the
+//	scores overflowed.
+
+bool striped::align( const dna& t, int stop, int reject, int slack )
+{
+	int tlen = t.length();
+	bool overflow = false;
+
+	score_ = xend_ = yend_ = columns_ = 0;
+	if( !exact_ || tlen < 1 || qlen_ < 1 )
+	{
+		return exact_;
+	}
+
+	target_.resize( tlen );
+	t.unpack( &target_[0] );
+
+	int limit8 = 255 - bias_ - maxs_;
+	if( stop > 0 && stop < limit8 )
+	{
+		score_ = byte_( aligned( prof8_, 0 ), aligned( work_, 0 ),
+			seg8_, qlen_, &target_[0], tlen, igo_, igx_, bias_,
+			limit8, stop, reject, slack, maxs_, xend_, yend_,
+			columns_, overflow );
+		if( !overflow )
+		{
+			return true;
+		}
+	}
+
+	score_ = word_( aligned( prof16_, 0 ), aligned( work_, 0 ), seg16_,
+		qlen_, &target_[0], tlen, igo_, igx_, 0, 32767 - maxs_, stop,
+		reject, slack, maxs_, xend_, yend_, columns_, overflow );
+
+	return !overflow;
+}
+
+/******************************************************************************/
+
+// align several targets against the query, in batches (see striped.h, 2.3).
+//	The score of each target is that align() would give, or -1 if its
+//	scores overflowed, and the number of its columns computed in columns. As
+//	for a single target, the 8-bit kernel is used if only the stop threshold
+//	matters, and the targets whose 8-bit scores overflow are aligned again
+//	with 16-bit scores.
+
+void striped::align( const vector<dna*>& t, vector<int>& scores,
+	vector<int>& columns, int stop, int reject, int slack )
+{
+	int n = static_cast<int>( t.size() );
+
+	scores.assign( n, exact_ ? 0 : -1 );
+	columns.assign( n, 0 );
+	if( !exact_ || qlen_ < 1 )
+	{
+		return;
+	}
+
+	// H and F columns of qlen_ vectors, and 2 * DNACODES + 1 more vectors
+	aligned( bwork_, ( 2 * qlen_ + 2 * DNACODES + 1 ) * bytes_ );
+
+	vector<int> which( n );
+	for( int k = 0; k < n; k++ )
+	{
+		which[k] = k;
+	}
+
+	// the kernels check the scores every two columns
+	int limit8 = 255 - bias_ - 2 * maxs_;
+	if( stop > 0 && stop < limit8 )
+	{
+		batch( bbyte_, t, which, bias_, 0, limit8, stop, reject, slack,
+			scores, columns );
+	}
+	batch( bword_, t, which, 0, -16384, 32767 - 2 * maxs_, stop, reject,
+		slack, scores, columns );
+
+	for( int k = 0; k < static_cast<int>( which.size() ); k++ )
+	{
+		scores[ which[k] ] = -1;
+	}
+}
+
+/******************************************************************************/
+
+// align the targets t[which[k]] with a batch kernel, storing their scores and
+//	the columns computed.
+//	which is left with the targets whose scores overflowed.
+
+void striped::batch( batchfn kernel, const vector<dna*>& t,
+	vector<int>& which, int bias, int pad, int limit, int stop, int reject,
+	int slack, vector<int>& scores, vector<int>& columns )
+{
+	int n = static_cast<int>( which.size() );
+	int k;
+	if( n == 0 )
+	{
+		return;
+	}
+
+	// unpack the targets one after the other
+	size_t total = 0;
+	blens_.resize( n );
+	bbest_.resize( n );
+	bcolumns_.resize( n );
+	for( k = 0; k < n; k++ )
+	{
+		blens_[k] = t[ which[k] ]->length();
+		total += blens_[k];
+	}
+	btargets_.resize( total > 0 ? total : 1 );
+	bptrs_.resize( n );
+	total = 0;
+	for( k = 0; k < n; k++ )
+	{
+		bptrs_[k] = &btargets_[total];
+		if( blens_[k] > 0 )
+		{
+			t[ which[k] ]->unpack( &btargets_[total] );
+		}
+		total += blens_[k];
+	}
+
+	kernel( &codes_[0], qlen_, &bptrs_[0], &blens_[0], n, &table_[0][0],
+		aligned( bwork_, 0 ), igo_, igx_, bias, pad, limit, stop, reject,
+		slack, maxs_, &bbest_[0], &bcolumns_[0] );
+
+	// the targets that overflowed are moved to the front of which
+	int overflows = 0;
+	for( k = 0; k < n; k++ )
+	{
+		if( bbest_[k] < 0 )
+		{
+			which[ overflows++ ] = which[k];
+		}
+		else
+		{
+			scores[ which[k] ] = bbest_[k];
+			columns[ which[k] ] = bcolumns_[k];
+		}
+	}
+	which.resize( overflows );
+}
+
+/******************************************************************************/
+
+// return a pointer into a buffer, aligned to the width of the SIMD registers.
+//	If size is positive the buffer is first resized to hold that many
+//	bytes (past the aligned pointer).
+
+char* striped::aligned( vector<char>& buffer, int size )
+{
+	if( size > 0 )
+	{
+		buffer.resize( size + bytes_ );
+	}
+	char* p = &buffer[0];
+	size_t misalign = reinterpret_cast<size_t>( p ) % bytes_;
+	return misalign ? p + ( bytes_ - misalign ) : p;
+}
+
+/******************************************************************************/
@@ -0,0 +1,203 @@
+	/*
+File:		striped.h
+Title:		Class declaration for class "striped", a vectorized (SIMD)
+		local alignment kernel computing alignment scores only.
+
+Description:
+
+1. OVERVIEW
+
+	The striped class implements Farrar's striped Smith-Waterman algorithm
+(M. Farrar, Bioinformatics 23(2), 2007). The query sequence (the x-sequence of
+a dynamic object) is split into segments that are processed in parallel by
+the lanes of a SIMD register, and each target nucleotide is aligned against
+all the segments at once. Dependencies along the query (gaps within a column)
+are resolved by the "lazy F" loop, which is rarely executed more than once.
+
+	Only the score and the end coordinates of the alignment are computed.
+The kernel is therefore used by dynamic in DYNSCORE mode (see dynamic.h).
+
+2. DATA MEMBERS
+
+	2.1. SCORING
+
+	Scores are saturating integers, taken from the integer substitution
+table of a dynamic object (see dynamic.h), i.e. its float rewards and
+penalties scaled by the smallest factor that makes all of them integral.
+
+	Two score widths are available: unsigned 8-bit (with a bias so that
+mismatch scores can be represented) and signed 16-bit. The 8-bit kernel has
+twice as many lanes, but it overflows after a few matches, so it is only used
+when the caller just needs to know whether a stop threshold is reached and
+that threshold fits in 8 bits. Otherwise the 16-bit kernel is used. This is
+why dynamic scores the pairs made of bases only with smaller integers (see
+dynamic.h, 3.7).
+
+	2.2. QUERY PROFILE
+
+	For each of the 16 nucleotide codes, the profile contains the scores of
+every query position against that code, laid out in the striped order. It
+is built once per query by query(), and reused for every target aligned
+against that query.
+
+	2.3. BATCHES
+
+	When one query is aligned against many targets, the targets can also be
+aligned in a batch, one per lane of a register (inter-sequence vectorization,
+as in T. Rognes' SWIPE, BMC Bioinformatics 12:221, 2011), with 8-bit scores
+if only a stop threshold matters, as above, and 16-bit ones otherwise (or
+for the targets whose 8-bit scores overflow). The cells of a column are then
+computed one query position at a time, for all the lanes at once, which needs
+no lazy F loop and keeps every lane busy however short the query is. A lane
+whose target is done (it reached the stop threshold, overflowed, could no
+longer reach the reject threshold, or ended) takes the next target at once,
+so that the lanes stay busy however different the lengths of the targets, and
+however early most of them are rejected. The scores of a column against each
+query code are gathered from the substitution table for every lane.
+
+	2.4. INSTRUCTION SET
+
+	The instruction set is selected once at runtime, depending on the CPU:
+AVX2 if available, else SSE2 on x86 processors, and NEON on ARM (AArch64).
+available() returns false on other processors. isa() returns the name of the
+selected instruction set.
+
+3. FUNCTIONS
+
+		- scoring(): sets the integer substitution table and gap
+	penalties. Returns false if they do not fit in 16 bits.
+		- query(): builds the query profile. Nothing is done if the
+	profile of the same dna object (and scoring) is already built.
+		- align(): aligns a target sequence against the query. If the stop
+	argument is positive, the alignment stops as soon as the (integer)
+	score reaches it. If the reject argument is positive, the alignment is
+	abandoned as soon as that score can no longer be reached, assuming
+	that a score grows by at most the highest substitution score per
+	nucleotide left, minus slack (the X-drop mode of dynamic, see
+	dynamic.h). The score is then that of the part of the alignment
+	performed. Returns false if the
+	scores overflowed, in which case the result is not valid.
+		- align() of a vector of targets: aligns each of them against the
+	query, lanes() targets at a time (see 2.3), with the same stop,
+	reject and slack for all. The score of each target (those of align()
+	for a single target) is returned in a vector, -1 meaning that its
+	scores overflowed, and the number of its columns computed in another
+	(see columns()). The end coordinates are not computed.
+		- score(), xend(), yend(): the results of the last alignment of
+	a single target. score() is in integer units, i.e. those of the
+	substitution table.
+		- columns(): the number of target columns computed by the last
+	alignment of a single target, i.e. its length unless the alignment
+	stopped or was abandoned. Each column is a column of query cells.
+		- lanes(): the number of targets in a batch.
+
+4. NOTES
+
+	The kernel keeps separate gap states (Gotoh's algorithm), like
+dynamic::align(), so its scores are the exact optimal local alignment scores
+for the given gap penalties, and the same as those of dynamic::align() (see
+dynamic.h).
+
+	*/
+
+#ifndef STRIPED_H
+#define STRIPED_H
+
+#include <vector>
+#include "dna.h"
+
+enum simdset { SIMDNONE, SIMDSSE2, SIMDAVX2, SIMDNEON };
+
+// signature of the instruction-set specific kernels (see stripedk.h)
+typedef int (*stripedfn)( const void* profile, void* work, int segLen,
+	int qlen, const unsigned char* target, int tlen, int go, int gx,
+	int bias, int limit, int stop, int reject, int slack, int gain,
+	int& xend, int& yend, int& columns, bool& overflow );
+typedef void (*batchfn)( const unsigned char* query, int qlen,
+	const unsigned char* const* targets, const int* tlens, int count,
+	const int* table, void* work, int go, int gx, int bias, int pad,
+	int limit, int stop, int reject, int slack, int gain, int* best,
+	int* columns );
+
+class striped
+{
+	public:
+		striped( void );
+
+		// "get" functions
+		int score( void ) const { return score_; }
+		int xend( void ) const { return xend_; }
+		int yend( void ) const { return yend_; }
+		int columns( void ) const { return columns_; }
+		static bool available( void ) { return isa_ != SIMDNONE; }
+		static const char* isa( void );
+		static int lanes( void ) { return bytes_; }
+
+		// "set" functions
+		bool scoring( const int*, int, int );
+		void query( const dna& );
+
+		// other functions
+		bool align( const dna&, int stop = 0, int reject = 0,
+			int slack = 0 );
+		void align( const vector<dna*>&, vector<int>&, vector<int>&,
+			int stop = 0, int reject = 0, int slack = 0 );
+
+	private:
+		// copying is not supported (the profile is easily rebuilt)
+		striped( const striped& );
+		striped& operator=( const striped& );
+
+		// build the profiles for the current query
+		void profile( void );
+
+		// align some of the targets with a batch kernel
+		void batch( batchfn, const vector<dna*>&, vector<int>&, int,
+			int, int, int, int, int, vector<int>&, vector<int>& );
+
+		// return a pointer into a buffer, aligned for SIMD loads
+		static char* aligned( vector<char>&, int );
+
+		// select the instruction set for the current CPU
+		static simdset select( void );
+
+	private:
+		const dna* query_;	// the query of the current profile
+		int qlen_;		// the length of the query
+		bool stale_;		// must the profile be rebuilt?
+
+		bool exact_;		// do the scores fit in 16 bits?
+		int table_[DNACODES][DNACODES];
+					// integer scores of each code pair
+		int igo_, igx_;		// integer gap penalties (positive)
+		int maxs_;		// highest score in the table
+		int bias_;		// bias of the 8-bit scores
+
+		int seg16_, seg8_;	// lengths of the segments
+		vector<char> prof16_;	// 16-bit query profile
+		vector<char> prof8_;	// 8-bit query profile
+		vector<char> work_;	// kernel workspace
+		vector<unsigned char> target_;
+					// codes of the target sequence
+		vector<unsigned char> codes_;	// codes of the query
+
+		vector<char> bwork_;	// batch kernel workspace
+		vector<unsigned char> btargets_;// codes of the batch targets
+		vector<const unsigned char*> bptrs_;	// where each starts
+		vector<int> blens_;	// the lengths of the batch targets
+		vector<int> bbest_;	// and their scores
+		vector<int> bcolumns_;	// and the columns computed
+
+		int score_;		// the results of the last alignment
+		int xend_, yend_;
+		int columns_;		// the target columns it computed
+
+		static simdset isa_;	// the selected instruction set
+		static stripedfn word_;	// 16-bit kernel
+		static stripedfn byte_;	// 8-bit kernel
+		static batchfn bword_;	// 16-bit batch kernel
+		static batchfn bbyte_;	// 8-bit batch kernel
+		static int bytes_;	// width of a SIMD register
+};
+
+#endif
@@ -0,0 +1,107 @@
+	/*
+File:		striped_avx2.cpp
+Title:		AVX2 version of the striped Smith-Waterman kernel
+Description:	This file must be compiled with AVX2 enabled (-mavx2). The
+		kernels are only called if the CPU supports AVX2 (see
+		striped::select() in striped.cpp). If the file is compiled
+		without AVX2, the kernels are null and never selected.
+	*/
+
+#include "striped.h"
+#include "stripedk.h"
+
+#ifdef __AVX2__
+
+#include <immintrin.h>
+
+/******************************************************************************/
+
+// AVX2 traits for the kernel (see stripedk.h). Shifting by one lane crosses the
+//	two 128-bit halves of the register, hence the permute.
+
+struct avx2word
+{
+	typedef __m256i V;
+	typedef short E;
+	static const int lanes = 16;
+
+	static V zero( void ) { return _mm256_setzero_si256(); }
+	static V set( int a ) { return _mm256_set1_epi16( a ); }
+	static V load( const V* p ) { return _mm256_load_si256( p ); }
+	static void store( V* p, V a ) { _mm256_store_si256( p, a ); }
+	static V addp( V h, V p, V ) { return _mm256_adds_epi16( h, p ); }
+	static V subs( V a, V b ) { return _mm256_subs_epu16( a, b ); }
+	static V max( V a, V b ) { return _mm256_max_epi16( a, b ); }
+	static V shift( V a )
+	{
+		return _mm256_alignr_epi8( a,
+			_mm256_permute2x128_si256( a, a, 0x08 ), 14 );
+	}
+	static bool anygt( V a, V b )
+		{ return _mm256_movemask_epi8( _mm256_cmpgt_epi16( a, b ) ) != 0; }
+	static int hmax( V a )
+	{
+		__m128i b = _mm_max_epi16( _mm256_castsi256_si128( a ),
+			_mm256_extracti128_si256( a, 1 ) );
+		b = _mm_max_epi16( b, _mm_srli_si128( b, 8 ) );
+		b = _mm_max_epi16( b, _mm_srli_si128( b, 4 ) );
+		b = _mm_max_epi16( b, _mm_srli_si128( b, 2 ) );
+		return static_cast<short>( _mm_extract_epi16( b, 0 ) );
+	}
+};
+
+struct avx2byte
+{
+	typedef __m256i V;
+	typedef unsigned char E;
+	static const int lanes = 32;
+
+	static V zero( void ) { return _mm256_setzero_si256(); }
+	static V set( int a )
+		{ return _mm256_set1_epi8( static_cast<char>( a ) ); }
+	static V load( const V* p ) { return _mm256_load_si256( p ); }
+	static void store( V* p, V a ) { _mm256_store_si256( p, a ); }
+	static V addp( V h, V p, V bias )
+		{ return _mm256_subs_epu8( _mm256_adds_epu8( h, p ), bias ); }
+	static V subs( V a, V b ) { return _mm256_subs_epu8( a, b ); }
+	static V max( V a, V b ) { return _mm256_max_epu8( a, b ); }
+	static V shift( V a )
+	{
+		return _mm256_alignr_epi8( a,
+			_mm256_permute2x128_si256( a, a, 0x08 ), 15 );
+	}
+	static bool anygt( V a, V b )
+	{
+		V d = _mm256_cmpeq_epi8( _mm256_subs_epu8( a, b ),
+			_mm256_setzero_si256() );
+		return _mm256_movemask_epi8( d ) != -1;
+	}
+	static int hmax( V a )
+	{
+		__m128i b = _mm_max_epu8( _mm256_castsi256_si128( a ),
+			_mm256_extracti128_si256( a, 1 ) );
+		b = _mm_max_epu8( b, _mm_srli_si128( b, 8 ) );
+		b = _mm_max_epu8( b, _mm_srli_si128( b, 4 ) );
+		b = _mm_max_epu8( b, _mm_srli_si128( b, 2 ) );
+		b = _mm_max_epu8( b, _mm_srli_si128( b, 1 ) );
+		return _mm_extract_epi16( b, 0 ) & 0xff;
+	}
+};
+
+/******************************************************************************/
+
+stripedfn stripedavx2word = stripedkernel<avx2word>;
+stripedfn stripedavx2byte = stripedkernel<avx2byte>;
+batchfn stripedavx2bword = stripedbatch<avx2word>;
+batchfn stripedavx2bbyte = stripedbatch<avx2byte>;
+
+#else
+
+stripedfn stripedavx2word = 0;
+stripedfn stripedavx2byte = 0;
+batchfn stripedavx2bword = 0;
+batchfn stripedavx2bbyte = 0;
+
+#endif
+
+/******************************************************************************/
@@ -0,0 +1,401 @@
+	/*
+File:		stripedk.h
+Title:		The striped Smith-Waterman kernel, generic on the instruction
+		set (for use by striped.cpp and striped_avx2.cpp only).
+
+Description:	The kernel is written once as a template over a "traits"
+		class T, which wraps the SIMD intrinsics of one instruction set
+		and score width. T must define:
+			- V: the vector type, and E: the element type
+			- lanes: the number of elements in a V
+			- zero(), set(int): constant vectors
+			- load(), store(): aligned memory access
+			- addp(h,p,bias): add the profile scores p to h
+			- subs(a,b): a-b, saturated at 0
+			- max(a,b): elementwise maximum
+			- shift(a): move every element one lane up, and
+			  insert 0 in the first lane
+			- anygt(a,b): is any element of a greater than b?
+			- hmax(a): the maximum element of a
+		See striped.h for a description of the algorithm.
+	*/
+
+#ifndef STRIPEDK_H
+#define STRIPEDK_H
+
+// the workspace holds four arrays of segLen vectors: two H columns (the one
+//	being computed and the previous one), the E column, and a copy of the H
+//	column in which the best score was found (to locate xend)
+
+//	If reject is positive, the alignment is abandoned as soon as no score of
+//	at least reject can be reached any more: from column j on, a score can
+//	grow by at most gain (the highest substitution score) per column left,
+//	minus the slack (see dynamic.h, 3.4).
+//	columns is set to the number of target columns computed, tlen unless the
+//	alignment stopped, overflowed or was abandoned.
+
+template <class T>
+int stripedkernel( const void* profile, void* work, int segLen, int qlen,
+	const unsigned char* target, int tlen, int go, int gx, int bias,
+	int limit, int stop, int reject, int slack, int gain, int& xend,
+	int& yend, int& columns, bool& overflow )
+{
+	typedef typename T::V V;
+	typedef typename T::E E;
+
+	const V* vProf = static_cast<const V*>( profile );
+	V* hStore = static_cast<V*>( work );
+	V* hLoad = hStore + segLen;
+	V* vEcol = hLoad + segLen;
+	V* hBest = vEcol + segLen;
+
+	V vZero = T::zero();
+	V vGo = T::set( go );
+	V vGx = T::set( gx );
+	V vBias = T::set( bias );
+
+	int best = 0;
+	int j, k;
+
+	overflow = false;
+	xend = yend = 0;
+
+	for( k = 0; k < segLen; k++ )
+	{
+		T::store( hStore + k, vZero );
+		T::store( hLoad + k, vZero );
+		T::store( vEcol + k, vZero );
+	}
+
+	for( j = 0; j < tlen; j++ )
+	{
+		V vF = vZero;
+		V vMax = vZero;
+
+		// the diagonal predecessor of the first segment is the last
+		// segment of the previous column, one lane down
+		V vH = T::shift( T::load( hStore + segLen - 1 ) );
+
+		const V* vP = vProf + target[j] * segLen;
+
+		V* swap = hLoad;
+		hLoad = hStore;
+		hStore = swap;
+
+		for( k = 0; k < segLen; k++ )
+		{
+			vH = T::addp( vH, T::load( vP + k ), vBias );
+
+			V vE = T::load( vEcol + k );
+			vH = T::max( vH, vE );
+			vH = T::max( vH, vF );
+			vMax = T::max( vMax, vH );
+			T::store( hStore + k, vH );
+
+			// gaps opened from this cell, or extended through it
+			vH = T::subs( vH, vGo );
+			vE = T::max( T::subs( vE, vGx ), vH );
+			T::store( vEcol + k, vE );
+			vF = T::max( T::subs( vF, vGx ), vH );
+
+			vH = T::load( hLoad + k );
+		}
+
+		// lazy F loop: carry the gaps within the column over the
+		// segment boundaries, for as long as they change any H value
+		vF = T::shift( vF );
+		k = 0;
+		vH = T::load( hStore );
+		while( T::anygt( vF, T::subs( vH, vGo ) ) )
+		{
+			vH = T::max( vH, vF );
+			vMax = T::max( vMax, vH );
+			T::store( hStore + k, vH );
+			T::store( vEcol + k,
+				T::max( T::load( vEcol + k ), T::subs( vH, vGo ) ) );
+			vF = T::subs( vF, vGx );
+			if( ++k == segLen )
+			{
+				k = 0;
+				vF = T::shift( vF );
+			}
+			vH = T::load( hStore + k );
+		}
+
+		// keep the column in which a new best score appears
+		int m = T::hmax( vMax );
+		if( m > best )
+		{
+			best = m;
+			yend = j;
+			for( k = 0; k < segLen; k++ )
+			{
+				T::store( hBest + k, T::load( hStore + k ) );
+			}
+			if( stop > 0 && best >= stop )
+			{
+				break;
+			}
+			if( best >= limit )
+			{
+				overflow = true;
+				break;
+			}
+		}
+
+		// the best score any alignment can still reach passes
+		// through the best cell of this column, or starts later
+		if( reject > 0 && best < reject )
+		{
+			int left = tlen - 1 - j;
+			int potential = gain * ( left < qlen ? left : qlen )
+				- slack;
+			if( m + potential < reject )
+			{
+				break;
+			}
+		}
+	}
+	columns = ( j < tlen ) ? j + 1 : tlen;
+
+	// locate the first query position with the best score
+	const E* h = reinterpret_cast<const E*>( hBest );
+	xend = qlen;
+	for( k = 0; k < segLen && best > 0; k++ )
+	{
+		for( int t = 0; t < T::lanes; t++ )
+		{
+			int i = t * segLen + k;
+			if( i < qlen && i < xend && h[k * T::lanes + t] == best )
+			{
+				xend = i;
+			}
+		}
+	}
+	if( xend == qlen )
+	{
+		xend = 0;
+	}
+
+	return best;
+}
+
+//	The batch kernel aligns the query against count targets, T::lanes of
+//	them at a time, one per lane (see striped.h, 2.3). Each step computes two
+//	columns of every lane, holding the next two nucleotides of the target of
+//	that lane, along the query, one vector per query position, so no lazy F
+//	loop is needed. The cells of the second column only depend on those of
+//	the first one at the same and previous query positions, so the two
+//	columns are computed together, and the latencies of their E chains
+//	overlap. As soon as the target of a lane is done, the next one takes its
+//	place, with the H and F columns of that lane cleared. The workspace holds
+//	2 * DNACODES vectors for the scores of the two columns against each query
+//	code, the H and F columns (qlen vectors each), and one vector to read the
+//	lanes from. The score of each target is returned in best[], or -1 if its
+//	scores overflowed, and the number of its columns computed in columns[]
+//	(an even number, but at most its length); bias, stop, reject, slack and
+//	gain work as in stripedkernel(), for each target separately, but are
+//	checked every two columns (so limit must leave room for two columns,
+//	and a target that reaches stop may score up to one column more than with
+//	stripedkernel).
+//	The scores of the lanes without a target, and of the column past the end
+//	of a target, are pad, which never extends an alignment.
+
+template <class T>
+void stripedbatch( const unsigned char* query, int qlen,
+	const unsigned char* const* targets, const int* tlens, int count,
+	const int* table, void* work, int go, int gx, int bias, int pad,
+	int limit, int stop, int reject, int slack, int gain, int* best,
+	int* columns )
+{
+	typedef typename T::V V;
+	typedef typename T::E E;
+
+	V* vCol = static_cast<V*>( work );
+	V* vNext = vCol + DNACODES;
+	V* hCol = vNext + DNACODES;
+	V* fCol = hCol + qlen;
+	V* vLanes = fCol + qlen;
+	E* lanes = reinterpret_cast<E*>( vLanes );
+
+	V vZero = T::zero();
+	V vGo = T::set( go );
+	V vGx = T::set( gx );
+	V vBias = T::set( bias );
+
+	// the target of each lane (-1 if none), and its current column
+	int target[T::lanes], column[T::lanes];
+	int next = 0, active = 0;
+	int i, l;
+
+	// only the scores of the codes found in the query are needed
+	bool used[DNACODES];
+	int codes[DNACODES], ncodes = 0;
+	for( i = 0; i < DNACODES; i++ )
+	{
+		used[i] = false;
+	}
+	for( i = 0; i < qlen; i++ )
+	{
+		if( !used[ query[i] ] )
+		{
+			used[ query[i] ] = true;
+			codes[ ncodes++ ] = query[i];
+		}
+	}
+
+	for( i = 0; i < qlen; i++ )
+	{
+		T::store( hCol + i, vZero );
+		T::store( fCol + i, vZero );
+	}
+	for( l = 0; l < T::lanes; l++ )
+	{
+		target[l] = -1;
+	}
+
+	for( ;; )
+	{
+		// give a target to every free lane, skipping the empty ones
+		for( l = 0; l < T::lanes; l++ )
+		{
+			if( target[l] >= 0 )
+			{
+				continue;
+			}
+			while( next < count && tlens[next] < 1 )
+			{
+				best[next] = columns[next] = 0;
+				next++;
+			}
+			if( next == count )
+			{
+				continue;
+			}
+			E* h = reinterpret_cast<E*>( hCol );
+			E* f = reinterpret_cast<E*>( fCol );
+			for( i = 0; i < qlen; i++ )
+			{
+				h[ i * T::lanes + l ] = 0;
+				f[ i * T::lanes + l ] = 0;
+			}
+			best[next] = 0;
+			target[l] = next++;
+			column[l] = 0;
+			active++;
+		}
+		if( active == 0 )
+		{
+			break;
+		}
+
+		// the scores of the nucleotides of the two columns against each
+		// query code (biased scores are unsigned bytes, like those of
+		// the 8-bit profile)
+		for( int c = 0; c < ncodes; c++ )
+		{
+			const int* row = table + codes[c] * DNACODES;
+			E* p = reinterpret_cast<E*>( vCol + codes[c] );
+			E* q = reinterpret_cast<E*>( vNext + codes[c] );
+			for( l = 0; l < T::lanes; l++ )
+			{
+				int s = pad, t = pad;
+				int k = target[l];
+				if( k >= 0 )
+				{
+					const unsigned char* y = targets[k] + column[l];
+					s = row[ y[0] ] + bias;
+					if( column[l] + 1 < tlens[k] )
+					{
+						t = row[ y[1] ] + bias;
+					}
+					if( bias > 0 )
+					{
+						s = ( s > 255 ) ? 255 : s;
+						t = ( t > 255 ) ? 255 : t;
+					}
+				}
+				p[l] = static_cast<E>( s );
+				q[l] = static_cast<E>( t );
+			}
+		}
+
+		V vE = vZero, vE2 = vZero;
+		V vDiag = vZero, vDiag2 = vZero;
+		V vMax = vZero;
+		for( i = 0; i < qlen; i++ )
+		{
+			V vLeft = T::load( hCol + i );
+			V vP = T::load( vCol + query[i] );
+			V vP2 = T::load( vNext + query[i] );
+
+			// the first column: the gap across the columns, and H
+			V vF = T::max( T::subs( T::load( fCol + i ), vGx ),
+				T::subs( vLeft, vGo ) );
+			V vH = T::addp( vDiag, vP, vBias );
+			vH = T::max( vH, vE );
+			vH = T::max( vH, vF );
+			vDiag = vLeft;
+			vE = T::max( T::subs( vE, vGx ), T::subs( vH, vGo ) );
+
+			// the second one, next to the cell just computed
+			V vF2 = T::max( T::subs( vF, vGx ), T::subs( vH, vGo ) );
+			V vH2 = T::addp( vDiag2, vP2, vBias );
+			vH2 = T::max( vH2, vE2 );
+			vH2 = T::max( vH2, vF2 );
+			vDiag2 = vH;
+			vE2 = T::max( T::subs( vE2, vGx ), T::subs( vH2, vGo ) );
+
+			vMax = T::max( vMax, T::max( vH, vH2 ) );
+			T::store( hCol + i, vH2 );
+			T::store( fCol + i, vF2 );
+		}
+
+		// the best score of each target, and whether it is done
+		T::store( vLanes, vMax );
+		for( l = 0; l < T::lanes; l++ )
+		{
+			int k = target[l];
+			if( k < 0 )
+			{
+				continue;
+			}
+			int m = lanes[l];
+			column[l] += 2;
+			int j = column[l] - 1;
+			bool done = ( j >= tlens[k] - 1 );
+			if( m > best[k] )
+			{
+				best[k] = m;
+				if( stop > 0 && m >= stop )
+				{
+					done = true;
+				}
+				else if( m >= limit )
+				{
+					best[k] = -1;
+					done = true;
+				}
+			}
+			if( !done && reject > 0 && best[k] < reject )
+			{
+				int left = tlens[k] - 1 - j;
+				int potential = gain * ( left < qlen ? left : qlen )
+					- slack;
+				if( m + potential < reject )
+				{
+					done = true;
+				}
+			}
+			if( done )
+			{
+				columns[k] = ( column[l] < tlens[k] ) ? column[l]
+					: tlens[k];
+				target[l] = -1;
+				active--;
+			}
+		}
+	}
+}
+
+#endif